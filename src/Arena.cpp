@@ -0,0 +1,47 @@
+#include "Arena.h"
+
+namespace C12 {
+
+    static thread_local AllocationCounters counters;
+    static thread_local std::pmr::memory_resource* current{nullptr};
+
+    /* the heap, counting every allocation made by the calling thread */
+    class CountingResource : public std::pmr::memory_resource {
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            ++counters.allocations;
+            counters.bytes += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    static CountingResource heap;
+
+    AllocationCounters allocationCounters() {
+        return counters;
+    }
+
+    std::pmr::memory_resource* tableResource() {
+        return current ? current : &heap;
+    }
+
+    Arena::Arena(std::size_t initialSize)
+        : resource{initialSize, &heap}
+    {
+    }
+
+    ArenaScope::ArenaScope(Arena* arena)
+        : previous{current}
+    {
+        current = arena ? arena->get() : nullptr;
+    }
+
+    ArenaScope::~ArenaScope() {
+        current = previous;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef ARENA_H
+#define ARENA_H
+#include <cstddef>
+#include <memory_resource>
+
+namespace C12 {
+
+    struct AllocationCounters {
+        std::size_t allocations = 0;
+        std::size_t bytes = 0;
+    };
+
+    // heap allocations made for tables by the calling thread so far
+    AllocationCounters allocationCounters();
+
+    // where tables, fields and their buffers are allocated on the calling thread
+    std::pmr::memory_resource* tableResource();
+
+    /*
+     * Monotonic arena for the tables of one meter.  Nothing allocated
+     * from it is freed until the arena itself is released or destroyed,
+     * so it must outlive every table built while it was in scope.
+     */
+    class Arena {
+    public:
+        explicit Arena(std::size_t initialSize = 16 * 1024);
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+        void release() { resource.release(); }
+        std::pmr::memory_resource* get() { return &resource; }
+    private:
+        std::pmr::monotonic_buffer_resource resource;
+    };
+
+    /*
+     * Makes the arena the table resource of the calling thread for the
+     * lifetime of the scope, or the heap if the arena is null.
+     */
+    class ArenaScope {
+    public:
+        explicit ArenaScope(Arena* arena);
+        ~ArenaScope();
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+    private:
+        std::pmr::memory_resource* previous;
+    };
+}
+
+#endif // ARENA_H
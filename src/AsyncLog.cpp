@@ -0,0 +1,253 @@
+#include "AsyncLog.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace C12 {
+
+    static std::size_t roundUp(std::size_t n) {
+        std::size_t size{64};
+        while (size < n)
+            size <<= 1;
+        return size;
+    }
+
+    ByteRing::ByteRing(std::size_t capacity) : buffer(roundUp(capacity)), mask{buffer.size() - 1} {}
+
+    std::size_t ByteRing::space() const {
+        return buffer.size() - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire));
+    }
+
+    std::size_t ByteRing::available() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+
+    void ByteRing::copyIn(std::size_t at, const char* data, std::size_t size) {
+        auto first{std::min(size, buffer.size() - (at & mask))};
+        std::memcpy(&buffer[at & mask], data, first);
+        std::memcpy(&buffer[0], data + first, size - first);
+    }
+
+    bool ByteRing::push(const char* data, std::size_t size) {
+        return push(data, size, nullptr, 0);
+    }
+
+    bool ByteRing::push(const char* first, std::size_t firstSize, const char* second, std::size_t secondSize) {
+        if (space() < firstSize + secondSize)
+            return false;
+        auto at{head.load(std::memory_order_relaxed)};
+        copyIn(at, first, firstSize);
+        copyIn(at + firstSize, second, secondSize);
+        head.store(at + firstSize + secondSize, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t ByteRing::pop(std::string& out, std::size_t max) {
+        auto from{tail.load(std::memory_order_relaxed)};
+        auto size{std::min(max, head.load(std::memory_order_acquire) - from)};
+        auto first{std::min(size, buffer.size() - (from & mask))};
+        out.append(&buffer[from & mask], first);
+        out.append(&buffer[0], size - first);
+        tail.store(from + size, std::memory_order_release);
+        return size;
+    }
+
+    /*
+     * In the ring a record is its kind, the time in microseconds and the
+     * size of its data, in the native byte order, followed by the data.
+     * The writer thread turns this into the compact form of the file.
+     */
+    constexpr std::size_t ringHeaderSize{1 + sizeof(std::int64_t) + sizeof(std::uint32_t)};
+
+    static void ringHeader(char* header, RecordKind kind, std::int64_t time, std::uint32_t size) {
+        header[0] = static_cast<char>(kind);
+        std::memcpy(header + 1, &time, sizeof time);
+        std::memcpy(header + 1 + sizeof time, &size, sizeof size);
+    }
+
+    static std::int64_t microsecondsNow() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    static void putVarint(std::string& out, std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    static bool getVarint(const std::string& in, std::size_t& pos, std::uint64_t& value) {
+        value = 0;
+        for (unsigned shift{0}; pos < in.size() && shift < 64; shift += 7) {
+            auto byte{static_cast<uint8_t>(in[pos++])};
+            value |= std::uint64_t(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    static const char magic[]{'C', '1', '2', 'L', 'O', 'G'};
+    static const char version{1};
+
+    AsyncLog::AsyncLog(const std::string& fileName) : AsyncLog(fileName, Options{}) {}
+
+    AsyncLog::AsyncLog(const std::string& fileName, const Options& options)
+        : options{options}, file{std::fopen(fileName.c_str(), "wb")}, ring{options.capacity}
+    {
+        if (file == nullptr)
+            throw std::runtime_error("cannot open " + fileName);
+        lastTime = microsecondsNow();
+        std::string header(magic, sizeof magic);
+        header.push_back(version);
+        for (unsigned i{0}; i < 8; ++i)
+            header.push_back(static_cast<char>(std::uint64_t(lastTime) >> (8 * i)));
+        if (std::fwrite(header.data(), 1, header.size(), file) != header.size())
+            failed = true;
+        writer = std::thread([this]{
+            auto lastSync{std::chrono::steady_clock::now()};
+            while (!stopping.load(std::memory_order_acquire)) {
+                {
+                    std::unique_lock<std::mutex> guard{wakeLock};
+                    wake.wait_for(guard, std::min(this->options.syncInterval, std::chrono::milliseconds{50}));
+                }
+                drain();
+                auto now{std::chrono::steady_clock::now()};
+                if (now - lastSync >= this->options.syncInterval) {
+                    sync();
+                    lastSync = now;
+                }
+            }
+            drain();
+            sync();
+        });
+    }
+
+    AsyncLog::~AsyncLog() {
+        stopping.store(true, std::memory_order_release);
+        wake.notify_one();
+        writer.join();
+        std::fclose(file);
+    }
+
+    bool AsyncLog::write(RecordKind kind, const char* data, std::size_t size) {
+        const std::size_t gapSize{pendingGap != 0 ? ringHeaderSize + sizeof pendingGap : 0};
+        const std::size_t needed{gapSize + ringHeaderSize + size};
+        // only the producer fills the ring, so room seen here cannot shrink before the push
+        while (ring.space() < needed) {
+            if (options.overflow == Overflow::drop || needed > ring.capacity() || !good()) {
+                ++pendingGap;
+                lost.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            wake.notify_one();
+            std::this_thread::yield();
+        }
+        auto now{microsecondsNow()};
+        char header[ringHeaderSize];
+        if (pendingGap != 0) {
+            ringHeader(header, RecordKind::gap, now, sizeof pendingGap);
+            ring.push(header, sizeof header, reinterpret_cast<const char*>(&pendingGap), sizeof pendingGap);
+            pendingGap = 0;
+        }
+        ringHeader(header, kind, now, static_cast<std::uint32_t>(size));
+        ring.push(header, sizeof header, data, size);
+        if (ring.available() >= ring.capacity() / 2)
+            wake.notify_one();
+        return true;
+    }
+
+    void AsyncLog::drain() {
+        std::string bytes;
+        ring.pop(bytes, ring.available());
+        if (bytes.empty() || !good())
+            return;     // after a failure the ring is still emptied, so a waiting producer is never stuck
+        std::string out;
+        out.reserve(bytes.size());
+        for (std::size_t pos{0}; pos + ringHeaderSize <= bytes.size(); ) {
+            std::int64_t time;
+            std::uint32_t size;
+            std::memcpy(&time, &bytes[pos + 1], sizeof time);
+            std::memcpy(&size, &bytes[pos + 1 + sizeof time], sizeof size);
+            auto kind{static_cast<RecordKind>(bytes[pos])};
+            pos += ringHeaderSize;
+            out.push_back(static_cast<char>(kind));
+            // a clock set back gives a delta of zero rather than a negative one
+            auto delta{std::max<std::int64_t>(time - lastTime, 0)};
+            lastTime += delta;
+            putVarint(out, static_cast<std::uint64_t>(delta));
+            if (kind == RecordKind::gap) {
+                std::uint64_t count;
+                std::memcpy(&count, &bytes[pos], sizeof count);
+                std::string data;
+                putVarint(data, count);
+                putVarint(out, data.size());
+                out += data;
+            } else {
+                putVarint(out, size);
+                out.append(bytes, pos, size);
+            }
+            pos += size;
+        }
+        if (std::fwrite(out.data(), 1, out.size(), file) != out.size())
+            failed = true;
+    }
+
+    void AsyncLog::sync() {
+        if (std::fflush(file) != 0)
+            failed = true;
+#ifdef _WIN32
+        _commit(_fileno(file));
+#else
+        fsync(fileno(file));
+#endif
+    }
+
+    bool isBinaryLog(std::istream& in) {
+        auto start{in.tellg()};
+        char head[sizeof magic]{};
+        in.read(head, sizeof head);
+        bool binary{in.gcount() == sizeof head && std::equal(std::begin(magic), std::end(magic), head)};
+        in.clear();
+        in.seekg(start);
+        return binary;
+    }
+
+    std::vector<LogRecord> readBinaryLog(std::istream& in) {
+        std::vector<LogRecord> records;
+        std::string bytes{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        const std::size_t headerSize{sizeof magic + 1 + 8};
+        if (bytes.size() < headerSize || !std::equal(std::begin(magic), std::end(magic), bytes.begin()))
+            throw std::runtime_error("not a binary monitor log");
+        if (bytes[sizeof magic] != version)
+            throw std::runtime_error("binary monitor log version " + std::to_string(int(bytes[sizeof magic])) + " is not known");
+        std::uint64_t time{0};
+        for (unsigned i{0}; i < 8; ++i)
+            time |= std::uint64_t(static_cast<uint8_t>(bytes[sizeof magic + 1 + i])) << (8 * i);
+        for (std::size_t pos{headerSize}; pos < bytes.size(); ) {
+            LogRecord record;
+            record.kind = static_cast<RecordKind>(bytes[pos++]);
+            std::uint64_t delta, size;
+            if (!getVarint(bytes, pos, delta) || !getVarint(bytes, pos, size) || size > bytes.size() - pos)
+                break;
+            time += delta;
+            record.time = std::chrono::system_clock::time_point{std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::microseconds{time})};
+            record.data = bytes.substr(pos, size);
+            pos += size;
+            if (record.kind == RecordKind::gap) {
+                std::size_t at{0};
+                getVarint(record.data, at, record.lost);
+                record.data.clear();
+            }
+            records.push_back(std::move(record));
+        }
+        return records;
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef ASYNCLOG_H
+#define ASYNCLOG_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace C12 {
+
+    /*
+     * Bytes passed from one producer thread to one consumer thread with
+     * no lock.  The producer only moves head and the consumer only moves
+     * tail, each publishing its move with release ordering after the
+     * bytes are copied.  The capacity is rounded up to a power of two.
+     */
+    class ByteRing {
+    public:
+        explicit ByteRing(std::size_t capacity);
+        std::size_t capacity() const { return buffer.size(); }
+        // room the producer can fill
+        std::size_t space() const;
+        // bytes the consumer can take
+        std::size_t available() const;
+        // all of data or none of it, called by the producer
+        bool push(const char* data, std::size_t size);
+        // two pieces pushed as one, so the consumer never sees only the first
+        bool push(const char* first, std::size_t firstSize, const char* second, std::size_t secondSize);
+        // appends up to max bytes to out, called by the consumer
+        std::size_t pop(std::string& out, std::size_t max);
+    private:
+        void copyIn(std::size_t at, const char* data, std::size_t size);
+        std::vector<char> buffer;
+        std::size_t mask;
+        alignas(64) std::atomic<std::size_t> head{0};
+        alignas(64) std::atomic<std::size_t> tail{0};
+    };
+
+    // what a record of a binary log holds
+    enum class RecordKind : uint8_t { text = 0, tx = 1, rx = 2, error = 3, gap = 0x7F };
+
+    // what to do with a message when the ring is full
+    enum class Overflow { drop, wait };
+
+    struct LogRecord {
+        RecordKind kind = RecordKind::text;
+        std::chrono::system_clock::time_point time{};
+        std::string data{};
+        std::uint64_t lost = 0;     // for a gap, how many messages were dropped
+    };
+
+    /*
+     * A communication log in a compact binary form, written by a thread
+     * of its own so that the thread doing meter I/O only copies each
+     * message into a ring.  The writer thread drains the ring to the file
+     * and flushes it to the disk every syncInterval, so a slow card costs
+     * the writer time and not the session.
+     *
+     * When the ring is full a message is dropped, and a gap record
+     * counting the messages lost is written before the next one that
+     * fits.  With Overflow::wait the producer waits for room instead,
+     * for logs that must be complete more than the session must be fast.
+     *
+     * The file starts with "C12LOG", a version byte and the start time in
+     * microseconds since 1970.  Each record is a kind byte, then the time
+     * since the previous record in microseconds and the size of the data,
+     * both LEB128, then the data.  The data of a gap is its count, LEB128.
+     */
+    class AsyncLog {
+    public:
+        struct Options {
+            std::size_t capacity = 1 << 20;
+            std::chrono::milliseconds syncInterval{1000};
+            Overflow overflow = Overflow::drop;
+        };
+        explicit AsyncLog(const std::string& fileName);
+        AsyncLog(const std::string& fileName, const Options& options);
+        AsyncLog(const AsyncLog&) = delete;
+        AsyncLog& operator=(const AsyncLog&) = delete;
+        // writes what is left in the ring, flushes it to the disk and closes the file
+        ~AsyncLog();
+        // false if the message was dropped; called from one thread only
+        bool write(RecordKind kind, const char* data, std::size_t size);
+        bool write(RecordKind kind, const std::string& data) { return write(kind, data.data(), data.size()); }
+        std::uint64_t dropped() const { return lost.load(std::memory_order_relaxed); }
+        // false once writing to the file has failed
+        bool good() const { return !failed.load(std::memory_order_relaxed); }
+    private:
+        void drain();
+        void sync();
+        Options options;
+        std::FILE* file;
+        ByteRing ring;
+        std::atomic<bool> stopping{false};
+        std::atomic<bool> failed{false};
+        std::atomic<std::uint64_t> lost{0};
+        std::uint64_t pendingGap = 0;       // dropped since the last record, producer only
+        std::int64_t lastTime = 0;          // writer only
+        std::mutex wakeLock{};
+        std::condition_variable wake{};
+        std::thread writer{};
+    };
+
+    // true if the stream starts like a binary log, which it is left at the start of
+    bool isBinaryLog(std::istream& in);
+
+    /*
+     * The records of a binary log.  A log cut short, as by a power
+     * failure, gives the records that were complete.
+     */
+    std::vector<LogRecord> readBinaryLog(std::istream& in);
+}
+
+#endif // ASYNCLOG_H
@@ -0,0 +1,76 @@
+#include "C1218Packet.h"
+
+namespace C12 {
+
+    static constexpr uint8_t STP{0xEE};
+    static constexpr std::size_t headerSize{6};
+
+    uint16_t crc16(const uint8_t* data, std::size_t len) {
+        uint16_t crc{0xFFFF};
+        while (len--) {
+            crc ^= *data++;
+            for (int bit{0}; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+            }
+        }
+        return ~crc;
+    }
+
+    std::string makePacket(uint8_t ctrl, uint8_t seq, const std::string& payload, uint8_t identity) {
+        std::string pkt{ static_cast<char>(STP), static_cast<char>(identity),
+            static_cast<char>(ctrl), static_cast<char>(seq),
+            static_cast<char>(payload.size() >> 8), static_cast<char>(payload.size()) };
+        pkt += payload;
+        auto crc{crc16(reinterpret_cast<const uint8_t*>(pkt.data()), pkt.size())};
+        pkt.push_back(static_cast<char>(crc & 0xFF));
+        pkt.push_back(static_cast<char>(crc >> 8));
+        return pkt;
+    }
+
+    std::vector<Packet> PacketParser::feed(const std::string& bytes) {
+        std::vector<Packet> packets;
+        pending += bytes;
+        std::size_t start{0};
+        for (;;) {
+            start = pending.find(static_cast<char>(STP), start);
+            if (start == std::string::npos) {
+                pending.clear();
+                break;
+            }
+            if (pending.size() - start < headerSize) {
+                pending.erase(0, start);
+                break;
+            }
+            const auto* pkt = reinterpret_cast<const uint8_t*>(pending.data() + start);
+            std::size_t len{static_cast<std::size_t>(pkt[4] << 8 | pkt[5])};
+            if (pending.size() - start < headerSize + len + 2) {
+                pending.erase(0, start);
+                break;
+            }
+            auto crc{crc16(pkt, headerSize + len)};
+            if (pkt[headerSize + len] != (crc & 0xFF) || pkt[headerSize + len + 1] != (crc >> 8)) {
+                ++start;    // not a packet after all, resynchronize
+                continue;
+            }
+            packets.push_back(Packet{pkt[1], pkt[2], pkt[3], pending.substr(start + headerSize, len)});
+            start += headerSize + len + 2;
+        }
+        return packets;
+    }
+
+    std::optional<std::string> MessageAssembler::add(const Packet& pkt) {
+        if (last && last->toggle() == pkt.toggle() && last->ctrl == pkt.ctrl
+                && last->seq == pkt.seq && last->payload == pkt.payload) {
+            return std::nullopt;    // duplicate
+        }
+        last = pkt;
+        if (!pkt.multiPacket() || pkt.firstPacket()) {
+            message.clear();
+        }
+        message += pkt.payload;
+        if (pkt.seq != 0) {
+            return std::nullopt;
+        }
+        return std::move(message);
+    }
+}
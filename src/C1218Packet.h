@@ -0,0 +1,48 @@
+#ifndef C1218PACKET_H
+#define C1218PACKET_H
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace C12 {
+
+    uint16_t crc16(const uint8_t* data, std::size_t len);
+    std::string makePacket(uint8_t ctrl, uint8_t seq, const std::string& payload, uint8_t identity = 0);
+
+    /* a C12.18 link layer packet with a valid CRC */
+    struct Packet {
+        uint8_t identity = 0;
+        uint8_t ctrl = 0;
+        uint8_t seq = 0;
+        std::string payload{};
+        bool multiPacket() const { return ctrl & 0x80; }
+        bool firstPacket() const { return ctrl & 0x40; }
+        bool toggle() const { return ctrl & 0x20; }
+    };
+
+    /*
+     * Splits a byte stream into packets.  Bytes between packets, such as
+     * ACK and NAK, and packets with a bad CRC are skipped.
+     */
+    class PacketParser {
+    public:
+        std::vector<Packet> feed(const std::string& bytes);
+    private:
+        std::string pending{};
+    };
+
+    /*
+     * Joins the packets of a multi-packet message and drops packets
+     * that were retransmitted because their ACK was lost.
+     */
+    class MessageAssembler {
+    public:
+        std::optional<std::string> add(const Packet& pkt);
+    private:
+        std::string message{};
+        std::optional<Packet> last{};
+    };
+}
+
+#endif // C1218PACKET_H
@@ -1,6 +1,16 @@
 #include "C12Meter.h"
+#include "TableDiff.h"
+#include "Tdl.h"
+#include <algorithm>
+#include <atomic>
 #include <cctype>
-#include <regex>
+#include <chrono>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 #include <signal.h>
 
 
@@ -8,7 +18,7 @@ class InterruptHandler          // this is actually a singleton
 {
     typedef void (*SignalHandlerType)(int);
     static SignalHandlerType s_previousInterruptHandler;
-    static bool s_isInterrupted;    // Here we know CEO is a singleton object.
+    static std::atomic<bool> s_isInterrupted;    // Here we know CEO is a singleton object.
 
     static void MyInterruptHandler(int) {
         s_isInterrupted = true;
@@ -18,10 +28,6 @@ public:
         return s_isInterrupted;
     }
 
-    static void ClearIsInterrupted() {
-        s_isInterrupted = false;
-    }
-
     InterruptHandler() {
         s_previousInterruptHandler = signal(SIGINT, MyInterruptHandler);    // Handle Ctrl-C
         M_ASSERT(s_previousInterruptHandler != MyInterruptHandler); // check we did not call it twice
@@ -32,11 +38,17 @@ public:
     }
 };
 
-bool InterruptHandler::s_isInterrupted = false;
+std::atomic<bool> InterruptHandler::s_isInterrupted{false};
 InterruptHandler::SignalHandlerType InterruptHandler::s_previousInterruptHandler = nullptr;
 static InterruptHandler s_interruptHandler;
 
-unsigned linkLayerRetries = 0;
+// per thread, as each meter of a fleet is read on a thread of its own
+static thread_local unsigned linkLayerRetries = 0;
+
+bool Meter::interrupted()
+{
+    return s_interruptHandler.IsInterrupted();
+}
 
 static void CommitCommunication(MProtocol& proto)
 {
@@ -45,7 +57,7 @@ static void CommitCommunication(MProtocol& proto)
         linkLayerRetries = proto.GetCountLinkLayerPacketsRetried();
         MUtilities::Sleep(100);
         if (s_interruptHandler.IsInterrupted()) {
-            s_interruptHandler.ClearIsInterrupted();
+            // left set, so that every session in progress is cancelled
             proto.GetChannel()->CancelCommunication(true);
         }
     }
@@ -182,8 +194,20 @@ static C12::Table MakeST6(std::string tbldata, Meter& meter)
     return ST6;
 }
 
-static void AppendST10_tail(C12::Table& ST10) 
+/*
+ * The conditions and dimensions of the layouts below are compiled once
+ * into static Expressions and only evaluated as each table is built.
+ * A table that was not read gives the fallback, which is chosen to
+ * keep the layout used before the condition was known.
+ */
+static long Evaluate(const Meter& meter, const C12::Expression& expression, long fallback = 0)
 {
+    return meter.evaluate(expression).value_or(fallback);
+}
+
+static void AppendST10_tail(C12::Table& ST10, const Meter& meter) 
+{
+    static const C12::Expression conversionAlg{"GEN_CONFIG_TBL.STD_VERSION_NO > 1"};
     ST10.addField("SOURCE_FLAGS", C12::Table::fieldtype::BITFIELD, 1);
     ST10.addSubfield("SOURCE_FLAGS", "PF_EXCLUDE_FLAG", 0);
     ST10.addSubfield("SOURCE_FLAGS", "RESET_EXCLUDE_FLAG", 1);
@@ -192,8 +216,8 @@ static void AppendST10_tail(C12::Table& ST10)
     ST10.addSubfield("SOURCE_FLAGS", "THERMAL_DEMAND_FLAG", 4);
     ST10.addSubfield("SOURCE_FLAGS", "SET1_PRESENT_FLAG", 5);
     ST10.addSubfield("SOURCE_FLAGS", "SET2_PRESENT_FLAG", 6);
-    // TODO this is filler unless GEN_CONFIG_TBL.STD_VERSION_NO > 1
-    ST10.addSubfield("SOURCE_FLAGS", "CONVERSION_ALG_FLAG", 7);
+    if (Evaluate(meter, conversionAlg, true))
+        ST10.addSubfield("SOURCE_FLAGS", "CONVERSION_ALG_FLAG", 7);
     ST10.addField("NBR_UOM_ENTRIES", C12::Table::fieldtype::UINT, 1);
     ST10.addField("NBR_DEMAND_CTRL_ENTRIES", C12::Table::fieldtype::UINT, 1);
     ST10.addField("DATA_CTRL_LENGTH", C12::Table::fieldtype::UINT, 1);
@@ -206,21 +230,22 @@ static void AppendST10_tail(C12::Table& ST10)
 static C12::Table MakeST10(std::string tbldata, Meter& meter) 
 {
     C12::Table ST10{10, "DIM_SOURCES_LIM_TBL", "SOURCE_RCD", tbldata};
-    AppendST10_tail(ST10);
+    AppendST10_tail(ST10, meter);
     return ST10;
 }
 
 static C12::Table MakeST11(std::string tbldata, Meter& meter) 
 {
     C12::Table ST11{11, "ACT_SOURCES_LIM_TBL", "SOURCE_RCD", tbldata};
-    AppendST10_tail(ST11);
+    AppendST10_tail(ST11, meter);
     return ST11;
 }
 
 static C12::Table MakeST12(std::string tbldata, Meter& meter)
 {
+    static const C12::Expression entries{"ACT_SOURCES_LIM_TBL.NBR_UOM_ENTRIES"};
     C12::Table ST12{12, "UOM_ENTRY_TBL", "UOM_ENTRY_RCD", tbldata};
-    ST12.addField("UOM_ENTRY", C12::Table::fieldtype::BITFIELD, 4, meter.evaluate("ACT_SOURCES_LIB_TBL.NBR_UOM_ENTRIES"));
+    ST12.addField("UOM_ENTRY", C12::Table::fieldtype::BITFIELD, 4, Evaluate(meter, entries));
     ST12.addSubfield("UOM_ENTRY", "ID_CODE", 0, 7);
     ST12.addSubfield("UOM_ENTRY", "TIME_BASE", 8, 10);
     ST12.addSubfield("UOM_ENTRY", "MULTIPLIER", 11, 13);
@@ -338,17 +363,101 @@ static C12::Table MakeST51(std::string tbldata, Meter& meter)
     return ST51;
 }
 
+/*
+ * LTIME_DATE, or STIME_DATE which has no seconds, as laid out for
+ * GEN_CONFIG_TBL.TM_FORMAT: 1 is BCD and 2 is one UINT8 per item,
+ * 3 counts minutes and 4 seconds since 1970, and 0 has no clock.
+ */
+static std::shared_ptr<C12::Record> MakeTimeDate(const std::string& name, bool seconds, const Meter& meter)
+{
+    static const C12::Expression tmFormat{"GEN_CONFIG_TBL.FORMAT_CONTROL_2.TM_FORMAT"};
+    auto rcd{std::make_shared<C12::Record>(name)};
+    auto format{Evaluate(meter, tmFormat, 2)};
+    switch (format) {
+    case 0:
+        break;
+    case 3:
+        rcd->addField("U_TIME", C12::Table::fieldtype::UINT, 4);
+        if (seconds)
+            rcd->addField("SECOND", C12::Table::fieldtype::UINT, 1);
+        break;
+    case 4:
+        rcd->addField("U_TIME_SEC", C12::Table::fieldtype::UINT, 4);
+        break;
+    default:
+        {
+            // BCD items are kept as the raw byte
+            auto type{format == 1 ? C12::Table::fieldtype::BINARY : C12::Table::fieldtype::UINT};
+            rcd->addField("YEAR", type, 1);
+            rcd->addField("MONTH", type, 1);
+            rcd->addField("DAY", type, 1);
+            rcd->addField("HOUR", type, 1);
+            rcd->addField("MINUTE", type, 1);
+            if (seconds)
+                rcd->addField("SECOND", type, 1);
+        }
+        break;
+    }
+    return rcd;
+}
+
+// size in bytes of a number in GEN_CONFIG_TBL.NI_FORMAT1 or NI_FORMAT2
+static std::size_t NiFormatSize(unsigned format)
+{
+    static const std::size_t sizes[]{8, 4, 12, 6, 4, 6, 4, 3, 4, 5, 6, 8, 21};
+    return format < std::size(sizes) ? sizes[format] : 0;
+}
+
+// integers that fit an unsigned are decoded, other formats are shown as they are
+static C12::Table::fieldtype NiFormatType(unsigned format)
+{
+    return format == 4 || format == 7 || format == 8 ? C12::Table::fieldtype::UINT : C12::Table::fieldtype::BINARY;
+}
+
+static C12::Table MakeST23(std::string tbldata, Meter& meter) 
+{
+    static const C12::Expression niFormat1{"GEN_CONFIG_TBL.FORMAT_CONTROL_3.NI_FORMAT1"};
+    static const C12::Expression niFormat2{"GEN_CONFIG_TBL.FORMAT_CONTROL_3.NI_FORMAT2"};
+    static const C12::Expression nbrOccur{"ACT_REGS_TBL.NBR_OCCUR"};
+    static const C12::Expression dateTimeField{"ACT_REGS_TBL.REG_FUNC1_FLAGS.DATA_TIME_FIELD_FLAG"};
+    static const C12::Expression cumDemand{"ACT_REGS_TBL.REG_FUNC1_FLAGS.CUM_DEMAND_FLAG"};
+    static const C12::Expression contCumDemand{"ACT_REGS_TBL.REG_FUNC1_FLAGS.CONT_CUM_DEMAND_FLAG"};
+    static const C12::Expression nbrSummations{"ACT_REGS_TBL.NBR_SUMMATIONS"};
+    static const C12::Expression nbrDemands{"ACT_REGS_TBL.NBR_DEMANDS"};
+    static const C12::Expression nbrCoinValues{"ACT_REGS_TBL.NBR_COIN_VALUES"};
+    static const C12::Expression demandResetCtr{"ACT_REGS_TBL.REG_FUNC1_FLAGS.DEMAND_RESET_CTR_FLAG"};
+    static const C12::Expression nbrTiers{"ACT_REGS_TBL.NBR_TIERS"};
+
+    auto ni1{Evaluate(meter, niFormat1)};
+    auto ni2{Evaluate(meter, niFormat2)};
+    auto occur{Evaluate(meter, nbrOccur)};
+    auto demands{std::make_shared<C12::Record>("DEMANDS_RCD")};
+    if (Evaluate(meter, dateTimeField))
+        demands->addField("EVENT_TIME", MakeTimeDate("STIME_DATE", false, meter), occur);
+    if (Evaluate(meter, cumDemand))
+        demands->addField("CUM_DEMAND", NiFormatType(ni1), NiFormatSize(ni1));
+    if (Evaluate(meter, contCumDemand))
+        demands->addField("CONT_CUM_DEMAND", NiFormatType(ni1), NiFormatSize(ni1));
+    demands->addField("DEMAND", NiFormatType(ni2), NiFormatSize(ni2), occur);
+    auto coincidents{std::make_shared<C12::Record>("COINCIDENTS_RCD")};
+    coincidents->addField("COINCIDENT_VALUES", NiFormatType(ni2), NiFormatSize(ni2), occur);
+    auto block{std::make_shared<C12::Record>("DATA_BLK_RCD")};
+    block->addField("SUMMATIONS", NiFormatType(ni1), NiFormatSize(ni1), Evaluate(meter, nbrSummations));
+    block->addField("DEMANDS", demands, Evaluate(meter, nbrDemands));
+    block->addField("COINCIDENTS", coincidents, Evaluate(meter, nbrCoinValues));
+
+    C12::Table ST23{23, "CURRENT_REG_DATA_TBL", "REGISTER_DATA_RCD", tbldata};
+    if (Evaluate(meter, demandResetCtr))
+        ST23.addField("NBR_DEMAND_RESETS", C12::Table::fieldtype::UINT, 1);
+    ST23.addField("TOT_DATA_BLOCK", block);
+    ST23.addField("TIER_DATA_BLOCK", block, Evaluate(meter, nbrTiers));
+    return ST23;
+}
+
 static C12::Table MakeST52(std::string tbldata, Meter& meter) 
 {
     C12::Table ST52{52, "CLOCK_TBL", "CLOCK_STATE_RCD", tbldata};
-    // this is only valid when GEN_CONFIG_TBL.TM_FORMAT == 2
-    //ST52.addField("CLOCK_CALENDAR", ltimedate);
-    ST52.addField("CLOCK_CALENDAR.YEAR", C12::Table::fieldtype::UINT, 1);
-    ST52.addField("CLOCK_CALENDAR.MONTH", C12::Table::fieldtype::UINT, 1);
-    ST52.addField("CLOCK_CALENDAR.DAY", C12::Table::fieldtype::UINT, 1);
-    ST52.addField("CLOCK_CALENDAR.HOUR", C12::Table::fieldtype::UINT, 1);
-    ST52.addField("CLOCK_CALENDAR.MINUTE", C12::Table::fieldtype::UINT, 1);
-    ST52.addField("CLOCK_CALENDAR.SECOND", C12::Table::fieldtype::UINT, 1);
+    ST52.addField("CLOCK_CALENDAR", MakeTimeDate("LTIME_DATE", true, meter));
     ST52.addField("TIME_DATE_QUAL", C12::Table::fieldtype::BITFIELD, 1);
     ST52.addSubfield("TIME_DATE_QUAL", "DAY_OF_WEEK", 0, 2);
     ST52.addSubfield("TIME_DATE_QUAL", "DST_FLAG", 3);
@@ -360,24 +469,21 @@ static C12::Table MakeST52(std::string tbldata, Meter& meter)
 
 static C12::Table MakeST55(std::string tbldata, Meter& meter) 
 {
+    static const C12::Expression separateSumDemands{"ACT_TIME_TOU_TBL.TIME_FUNC_FLAG2_BFLD.SEPARATE_SUM_DEMANDS_FLAG"};
     C12::Table ST55{55, "CLOCK_STATE_TBL", "CLOCK_STATE_RCD", tbldata};
-    // this is only valid when GEN_CONFIG_TBL.TM_FORMAT == 2
-    //ST55.addField("CLOCK_CALENDAR", ltimedate);
-    ST55.addField("CLOCK_CALENDAR.YEAR", C12::Table::fieldtype::UINT, 1);
-    ST55.addField("CLOCK_CALENDAR.MONTH", C12::Table::fieldtype::UINT, 1);
-    ST55.addField("CLOCK_CALENDAR.DAY", C12::Table::fieldtype::UINT, 1);
-    ST55.addField("CLOCK_CALENDAR.HOUR", C12::Table::fieldtype::UINT, 1);
-    ST55.addField("CLOCK_CALENDAR.MINUTE", C12::Table::fieldtype::UINT, 1);
-    ST55.addField("CLOCK_CALENDAR.SECOND", C12::Table::fieldtype::UINT, 1);
+    ST55.addField("CLOCK_CALENDAR", MakeTimeDate("LTIME_DATE", true, meter));
     ST55.addField("TIME_DATE_QUAL", C12::Table::fieldtype::BITFIELD, 1);
     ST55.addSubfield("TIME_DATE_QUAL", "DAY_OF_WEEK", 0, 2);
     ST55.addSubfield("TIME_DATE_QUAL", "DST_FLAG", 3);
     ST55.addSubfield("TIME_DATE_QUAL", "GMT_FLAG", 4);
     ST55.addSubfield("TIME_DATE_QUAL", "DST_APPLIED_FLAG", 6);
     ST55.addField("STATUS", C12::Table::fieldtype::BITFIELD, 2);
-    // only valid when ACT_TIME_TOU_TBL>SEPARATE_SUM_DEMANDS_FLAG is false
-    ST55.addSubfield("STATUS", "CURR_TIER", 0, 2);
-    // ENDIF
+    if (Evaluate(meter, separateSumDemands)) {
+        ST55.addSubfield("STATUS", "CURR_SUM_TIER", 0, 2);
+        ST55.addSubfield("STATUS", "CURR_DEMAND_TIER", 3, 5);
+    } else {
+        ST55.addSubfield("STATUS", "CURR_TIER", 0, 2);
+    }
     ST55.addSubfield("STATUS", "TIER_DRIVE", 6, 7);
     ST55.addSubfield("STATUS", "SPECIAL_SCHD_ACTIVE", 8, 11);
     ST55.addSubfield("STATUS", "SEASON", 12, 15);
@@ -386,16 +492,27 @@ static C12::Table MakeST55(std::string tbldata, Meter& meter)
 
 static C12::Table MakeST56(std::string tbldata, Meter& meter) 
 {
+    static const C12::Expression separateSumDemands{"ACT_TIME_TOU_TBL.TIME_FUNC_FLAG2_BFLD.SEPARATE_SUM_DEMANDS_FLAG"};
     C12::Table ST56{56, "TIME_REMAIN_TBL", "TIME_REMAIN_RCD", tbldata};
-    // only valid when ACT_TIME_TOU_TBL>SEPARATE_SUM_DEMANDS_FLAG is false
-    ST56.addField("TIER_TIME_REMAIN", C12::Table::fieldtype::UINT, 2);
+    if (Evaluate(meter, separateSumDemands)) {
+        ST56.addField("SUM_TIER_TIME_REMAIN", C12::Table::fieldtype::UINT, 2);
+        ST56.addField("DEMAND_TIER_TIME_REMAIN", C12::Table::fieldtype::UINT, 2);
+    } else {
+        ST56.addField("TIER_TIME_REMAIN", C12::Table::fieldtype::UINT, 2);
+    }
     ST56.addField("SELF_READ_DAYS_REMAIN", C12::Table::fieldtype::UINT, 1);
-    // ENDIF
     return ST56;
 }
 
-static void AppendST60_tail(C12::Table& ST60) 
+static void AppendST60_tail(C12::Table& ST60, const Meter& meter) 
 {
+    // load profile data sets 1 to 4 are ST64 to ST67
+    static const C12::Expression setUsed[]{
+        C12::Expression{"GEN_CONFIG_TBL.STD_TBLS_USED[64]"},
+        C12::Expression{"GEN_CONFIG_TBL.STD_TBLS_USED[65]"},
+        C12::Expression{"GEN_CONFIG_TBL.STD_TBLS_USED[66]"},
+        C12::Expression{"GEN_CONFIG_TBL.STD_TBLS_USED[67]"},
+    };
     ST60.addField("LP_MEMORY_LEN", C12::Table::fieldtype::UINT, 4);
     ST60.addField("LP_FLAGS", C12::Table::fieldtype::BITFIELD, 2);
     ST60.addSubfield("LP_FLAGS", "LP_SET1_INHIBIT_OVF_FLAG", 0);
@@ -420,31 +537,29 @@ static void AppendST60_tail(C12::Table& ST60)
     ST60.addSubfield("LP_FMATS", "INV_INT32_FLAG", 5);
     ST60.addSubfield("LP_FMATS", "INV_NI_FMAT1_FLAG", 6);
     ST60.addSubfield("LP_FMATS", "INV_NI_FMAT2_FLAG", 7);
-    // if ST64 is present
-    ST60.addField("NBR_BLKS_SET1", C12::Table::fieldtype::UINT, 2);
-    ST60.addField("NBR_BLK_INTS_SET1", C12::Table::fieldtype::UINT, 2);
-    ST60.addField("NBR_CHNS_SET1", C12::Table::fieldtype::UINT, 1);
-    ST60.addField("MAX_INT_TIME_SET1", C12::Table::fieldtype::UINT, 1);
-    // if ST65 is present
-#if ENABLEST65
-    ST60.addField("NBR_BLKS_SET2", C12::Table::fieldtype::UINT, 2);
-    ST60.addField("NBR_BLK_INTS_SET2", C12::Table::fieldtype::UINT, 2);
-    ST60.addField("NBR_CHNS_SET2", C12::Table::fieldtype::UINT, 1);
-    ST60.addField("MAX_INT_TIME_SET2", C12::Table::fieldtype::UINT, 1);
-#endif
+    for (unsigned set{1}; set <= std::size(setUsed); ++set) {
+        // without GEN_CONFIG_TBL only set 1 is assumed, as it always was
+        if (!Evaluate(meter, setUsed[set - 1], set == 1))
+            continue;
+        auto suffix{"_SET" + std::to_string(set)};
+        ST60.addField("NBR_BLKS" + suffix, C12::Table::fieldtype::UINT, 2);
+        ST60.addField("NBR_BLK_INTS" + suffix, C12::Table::fieldtype::UINT, 2);
+        ST60.addField("NBR_CHNS" + suffix, C12::Table::fieldtype::UINT, 1);
+        ST60.addField("MAX_INT_TIME" + suffix, C12::Table::fieldtype::UINT, 1);
+    }
 }
 
 static C12::Table MakeST60(std::string tbldata, Meter& meter) 
 {
     C12::Table ST60{60, "DIM_LP_TBL", "LP_SET_RCD", tbldata};
-    AppendST60_tail(ST60);
+    AppendST60_tail(ST60, meter);
     return ST60;
 }
 
 static C12::Table MakeST61(std::string tbldata, Meter& meter) 
 {
     C12::Table ST61{61, "ACT_LP_TBL","LP_SET_RCD",  tbldata};
-    AppendST60_tail(ST61);
+    AppendST60_tail(ST61, meter);
     return ST61;
 }
 
@@ -480,21 +595,29 @@ static C12::Table MakeST71(std::string tbldata, Meter& meter)
 
 static C12::Table MakeST72(std::string tbldata, Meter& meter) 
 {
+    static const C12::Expression nbrStdEvents{"ACT_LOG_TBL.NBR_STD_EVENTS"};
+    static const C12::Expression nbrMfgEvents{"ACT_LOG_TBL.NBR_MFG_EVENTS"};
     C12::Table ST72{72, "EVENTS_ID_TBL", "EVENTS_SUPPORTED_RCD", tbldata};
-    ST72.addField("STD_EVENTS_SUPPORTED", C12::Table::fieldtype::SET, meter.evaluate("ACT_LOG_TBL.NBR_STD_EVENTS"));
-    ST72.addField("MFG_EVENTS_SUPPORTED", C12::Table::fieldtype::SET, meter.evaluate("ACT_LOG_TBL.NBR_MFG_EVENTS"));
+    ST72.addField("STD_EVENTS_SUPPORTED", C12::Table::fieldtype::SET, Evaluate(meter, nbrStdEvents));
+    ST72.addField("MFG_EVENTS_SUPPORTED", C12::Table::fieldtype::SET, Evaluate(meter, nbrMfgEvents));
     return ST72;
 }
 
 static C12::Table MakeST73(std::string tbldata, Meter& meter) 
 {
-    C12::Table ST73{73, "EVENTS_ID_TBL", "HISTORY_CTRL_RCD", tbldata};
-    ST73.addField("STD_EVENTS_MONITORED_FLAGS", C12::Table::fieldtype::SET, meter.evaluate("ACT_LOG_TBL.NBR_STD_EVENTS"));
-    ST73.addField("MFG_EVENTS_MONITORED_FLAGS", C12::Table::fieldtype::SET, meter.evaluate("ACT_LOG_TBL.NBR_MFG_EVENTS"));
-    ST73.addField("STD_TBLS_MONITORED_FLAGS", C12::Table::fieldtype::SET, meter.evaluate("GEN_CONFIG_TBL.DIM_STD_TBLS_USED"));
-    ST73.addField("MFG_TBLS_MONITORED_FLAGS", C12::Table::fieldtype::SET, meter.evaluate("GEN_CONFIG_TBL.DIM_MFG_TBLS_USED"));
-    ST73.addField("STD_PROC_MONITORED_FLAGS", C12::Table::fieldtype::SET, meter.evaluate("GEN_CONFIG_TBL.DIM_STD_PROC_USED"));
-    ST73.addField("MFG_PROC_MONITORED_FLAGS", C12::Table::fieldtype::SET, meter.evaluate("GEN_CONFIG_TBL.DIM_MFG_PROC_USED"));
+    static const C12::Expression nbrStdEvents{"ACT_LOG_TBL.NBR_STD_EVENTS"};
+    static const C12::Expression nbrMfgEvents{"ACT_LOG_TBL.NBR_MFG_EVENTS"};
+    static const C12::Expression dimStdTbls{"GEN_CONFIG_TBL.DIM_STD_TBLS_USED"};
+    static const C12::Expression dimMfgTbls{"GEN_CONFIG_TBL.DIM_MFG_TBLS_USED"};
+    static const C12::Expression dimStdProc{"GEN_CONFIG_TBL.DIM_STD_PROC_USED"};
+    static const C12::Expression dimMfgProc{"GEN_CONFIG_TBL.DIM_MFG_PROC_USED"};
+    C12::Table ST73{73, "HISTORY_LOG_CTRL_TBL", "HISTORY_CTRL_RCD", tbldata};
+    ST73.addField("STD_EVENTS_MONITORED_FLAGS", C12::Table::fieldtype::SET, Evaluate(meter, nbrStdEvents));
+    ST73.addField("MFG_EVENTS_MONITORED_FLAGS", C12::Table::fieldtype::SET, Evaluate(meter, nbrMfgEvents));
+    ST73.addField("STD_TBLS_MONITORED_FLAGS", C12::Table::fieldtype::SET, Evaluate(meter, dimStdTbls));
+    ST73.addField("MFG_TBLS_MONITORED_FLAGS", C12::Table::fieldtype::SET, Evaluate(meter, dimMfgTbls));
+    ST73.addField("STD_PROC_MONITORED_FLAGS", C12::Table::fieldtype::SET, Evaluate(meter, dimStdProc));
+    ST73.addField("MFG_PROC_MONITORED_FLAGS", C12::Table::fieldtype::SET, Evaluate(meter, dimMfgProc));
     return ST73;
 }
 
@@ -597,12 +720,95 @@ static int stringToTableNumber(const MStdString& tblid)
                 return -1;
         }
     }
-    return number + offset;
+    return state == States::Digits ? number + offset : -1;
+}
+
+bool Meter::isTable(const std::string& item)
+{
+    return stringToTableNumber(item) >= 0;
+}
+
+std::string Meter::itemName(int itemInt)
+{
+    return itemInt < 2048 ? "ST" + std::to_string(itemInt) : "MT" + std::to_string(itemInt - 2048);
+}
+
+/*
+ * Queues whatever the passed action queues, commits it and measures how
+ * long that took and what it cost on the link.
+ */
+template <class Action>
+static C12::PhaseSample MeasuredCommit(MProtocol& proto, Action queue)
+{
+    MChannel* channel = proto.GetChannel();
+    auto sent{channel->GetCountBytesWritten()};
+    auto received{channel->GetCountBytesRead()};
+    auto retries{proto.GetCountLinkLayerPacketsRetried()};
+    auto start{std::chrono::steady_clock::now()};
+    queue();
+    CommitCommunication(proto);
+    C12::PhaseSample sample;
+    sample.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    sample.bytesSent = channel->GetCountBytesWritten() - sent;
+    sample.bytesReceived = channel->GetCountBytesRead() - received;
+    sample.retries = proto.GetCountLinkLayerPacketsRetried() - retries;
+    return sample;
+}
+
+template <class Action>
+static void TimedCommit(MProtocol& proto, C12::SessionStats& stats, C12::Phase phase, const std::string& item, Action queue)
+{
+    stats.record(phase, item, MeasuredCommit(proto, queue));
+}
+
+/*
+ * Commits what the passed action queues, timed when statistics are kept.
+ */
+template <class Action>
+static void Commit(MProtocol& proto, C12::SessionStats* stats, C12::Phase phase, const std::string& item, Action queue)
+{
+    if (stats != nullptr) {
+        TimedCommit(proto, *stats, phase, item, queue);
+    } else {
+        queue();
+        CommitCommunication(proto);
+    }
+}
+
+// a channel kept open from an earlier meter needs no connect
+static bool Connected(MProtocol& proto)
+{
+    MChannel* channel = proto.GetChannel();
+    return channel != nullptr && channel->IsConnected();
 }
 
+static const char hexDumpMask[]{"  XX XX XX XX  XX XX XX XX  XX XX XX XX  XX XX XX XX\n"};
+
 void Meter::Communicate(MProtocol& proto, const MStdStringVector& tables)
 {
-    proto.QConnect();
+    results.clear();
+    streamed.clear();
+    skipped.clear();
+    if (chunked) {
+        CommunicateChunked(proto, tables);
+        return;
+    }
+    // a function may change what a later read returns, so it waits its turn
+    if (pipelineWindow > 1 && makeLink && std::all_of(tables.begin(), tables.end(),
+            [](const MStdString& item) { return stringToTableNumber(item) >= 0; })) {
+        CommunicatePipelined(tables);
+        return;
+    }
+    if (priorities || deadline.count() != 0) {
+        CommunicatePrioritized(proto, tables);
+        return;
+    }
+    if (stats != nullptr) {
+        CommunicateTimed(proto, tables);
+        return;
+    }
+    if (!Connected(proto))
+        proto.QConnect();
     proto.QStartSession();
 
     int count {1};
@@ -613,253 +819,412 @@ void Meter::Communicate(MProtocol& proto, const MStdStringVector& tables)
     CommitCommunication(proto);
 }
 
-long Meter::evaluate(const std::string& expression) 
+/*
+ * Same exchange as the queued one in Communicate, but each phase is
+ * committed on its own so that it can be timed.  Table data is fetched
+ * right after each read and kept for GetResults.
+ */
+void Meter::CommunicateTimed(MProtocol& proto, const MStdStringVector& tables)
+{
+    if (!Connected(proto))
+        TimedCommit(proto, *stats, C12::Phase::Connect, "", [&proto]{ proto.QConnect(); });
+    TimedCommit(proto, *stats, C12::Phase::StartSession, "", [&proto]{ proto.QStartSession(); });
+    int count {1};
+    for (const auto & item: tables) {
+        TimedCommit(proto, *stats, C12::Phase::Read, item, [&]{ ReadItem(proto, item, count); });
+        results[count] = proto.QGetTableData(stringToTableNumber(item), count);
+        ++count;
+    }
+    TimedCommit(proto, *stats, C12::Phase::EndSession, "", [&proto]{ proto.QEndSession(); });
+}
+
+/*
+ * Reads each item in a request of its own, highest priority first, so
+ * that when the deadline passes what is left unread matters least.  A
+ * read in flight at the deadline is finished, and the session is ended
+ * as usual.  Each result keeps the position of its item, so GetResults
+ * still decodes in the given order, in which the tables that others
+ * depend on come first.
+ */
+void Meter::CommunicatePrioritized(MProtocol& proto, const MStdStringVector& tables)
+{
+    auto stop{std::chrono::steady_clock::now() + deadline};
+    if (!Connected(proto))
+        Commit(proto, stats, C12::Phase::Connect, "", [&proto]{ proto.QConnect(); });
+    Commit(proto, stats, C12::Phase::StartSession, "", [&proto]{ proto.QStartSession(); });
+    static const C12::Priorities defaults;
+    for (auto i : (priorities ? *priorities : defaults).order(tables)) {
+        const auto& item{tables[i]};
+        int count{static_cast<int>(i) + 1};
+        if (deadline.count() != 0 && std::chrono::steady_clock::now() >= stop) {
+            skipped[count] = item;
+            continue;
+        }
+        Commit(proto, stats, C12::Phase::Read, item, [&]{ ReadItem(proto, item, count); });
+        results[count] = proto.QGetTableData(stringToTableNumber(item), count);
+    }
+    Commit(proto, stats, C12::Phase::EndSession, "", [&proto]{ proto.QEndSession(); });
+}
+
+MStdStringVector Meter::unread() const
+{
+    MStdStringVector items;
+    for (const auto& entry : skipped)
+        items.push_back(entry.second);
+    return items;
+}
+
+/*
+ * Reads each table in chunks of what one response can carry.  A table
+ * with a layout is kept whole for GetResults to decode, as the layout
+ * may need any part of it.  Any other table, such as a load profile, is
+ * printed a chunk at a time, so memory stays the same however large it
+ * is.  Functions are executed as usual.
+ */
+void Meter::CommunicateChunked(MProtocol& proto, const MStdStringVector& tables)
+{
+    if (!Connected(proto))
+        Commit(proto, stats, C12::Phase::Connect, "", [&proto]{ proto.QConnect(); });
+    Commit(proto, stats, C12::Phase::StartSession, "", [&proto]{ proto.QStartSession(); });
+    auto size{chunkSize(proto)};
+    int count {1};
+    for (const auto & item: tables) {
+        auto itemInt{stringToTableNumber(item)};
+        if (itemInt < 0) {
+            Commit(proto, stats, C12::Phase::Read, item, [&]{ ReadItem(proto, item, count); });
+            results[count] = proto.QGetTableData(itemInt, count);
+        } else if (builders().find(itemInt, manufacturerSet) != nullptr) {
+            MByteString data;
+            readChunked(proto, itemInt, size, [&data](std::size_t, const MByteString& chunk) { data += chunk; });
+            results[count] = std::move(data);
+        } else {
+            out << item << ":\n";
+            readChunked(proto, itemInt, size, [this](std::size_t, const MByteString& chunk) {
+                out << MUtilities::BytesToHexString(chunk, hexDumpMask);
+            });
+            out << '\n';
+            streamed.insert(count);
+        }
+        ++count;
+    }
+    Commit(proto, stats, C12::Phase::EndSession, "", [&proto]{ proto.QEndSession(); });
+}
+
+/*
+ * Keeps up to pipelineWindow table reads in flight, each sessionless
+ * request on a link of its own, so that reading many tables costs about
+ * one round trip per window rather than one per table.  Each response is
+ * kept under the position of its request, whatever order they arrive
+ * in.  A request that times out is sent again on its own, and the first
+ * error that persists stops the links and is thrown once all are done.
+ */
+void Meter::CommunicatePipelined(const MStdStringVector& tables)
 {
-    std::regex field_regex("([A-Z_]+)\\.([A-Z_]+)");
-    std::smatch pieces;
-    std::string tblname, fieldname;
-    if (std::regex_match(expression, pieces, field_regex)) {
-        for (size_t i = 0; i < pieces.size(); ++i) {
-#if VERBOSE_DEBUG            
-            std::ssub_match sub_match = pieces[i];
-            std::string piece = sub_match.str();
-            std::cout << "  submatch " << i << ": " << piece << '\n';
-#endif
-            if (i == 1) {
-                tblname = pieces[i].str();
+    static constexpr unsigned attempts{3};
+    std::mutex lock;
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr error;
+    const auto worker = [&]{
+        std::unique_ptr<MProtocol> link;
+        try {
+            link = makeLink();
+            bool started{false};
+            for (auto i{next++}; i < tables.size(); i = next++) {
+                const auto& item{tables[i]};
+                int count{static_cast<int>(i) + 1};
+                for (unsigned attempt{1}; ; ++attempt) {
+                    try {
+                        auto sample{MeasuredCommit(*link, [&]{
+                            if (!started) {
+                                if (!Connected(*link))
+                                    link->QConnect();
+                                link->QStartSession();
+                            }
+                            ReadItem(*link, item, count);
+                        })};
+                        started = true;
+                        auto data{link->QGetTableData(stringToTableNumber(item), count)};
+                        std::lock_guard<std::mutex> guard{lock};
+                        results[count] = std::move(data);
+                        if (stats != nullptr)
+                            stats->record(C12::Phase::Read, item, sample);
+                        break;
+                    }
+                    catch (MEChannelReadTimeout&) {
+                        if (attempt == attempts)
+                            throw;
+                    }
+                }
             }
-            if (i == 2) {
-                fieldname = pieces[i].str();
+            if (started) {
+                link->QEndSession();
+                CommitCommunication(*link);
             }
         }
-    }   
-    for (const auto& t : table) {
-        if (t.Name() == tblname) {
-            return t.value(fieldname);
+        catch (...) {
+            std::lock_guard<std::mutex> guard{lock};
+            if (!error)
+                error = std::current_exception();
+            next = tables.size();
         }
-    }
-    return 0;    
+        if (link != nullptr) {
+            link->Disconnect();     // never throws
+            std::lock_guard<std::mutex> guard{lock};
+            linkRetries += link->GetCountLinkLayerPacketsRetried();
+        }
+    };
+    // the link read on this thread must not stand in for the protocol's own count
+    auto ownRetries{linkLayerRetries};
+    std::vector<std::thread> links;
+    auto window{std::min<std::size_t>(pipelineWindow, tables.size())};
+    for (std::size_t i{1}; i < window; ++i)
+        links.emplace_back(worker);
+    worker();
+    for (auto& t : links)
+        t.join();
+    linkLayerRetries = ownRetries;
+    if (error)
+        std::rethrow_exception(error);
 }
 
-std::string Meter::evaluateAsString(const std::string& expression) const 
+std::size_t Meter::readChunked(MProtocol& proto, int itemInt, unsigned chunkSize, const ChunkConsumer& consume)
 {
-    std::regex field_regex("([A-Z_]+)\\.([A-Z_]+)");
-    std::smatch pieces;
-    std::string tblname, fieldname;
-    if (std::regex_match(expression, pieces, field_regex)) {
-        for (size_t i = 0; i < pieces.size(); ++i) {
-#if VERBOSE_DEBUG            
-            std::ssub_match sub_match = pieces[i];
-            std::string piece = sub_match.str();
-            std::cout << "  submatch " << i << ": " << piece << '\n';
-#endif
-            if (i == 1) {
-                tblname = pieces[i].str();
+    // the refused read that can end a table must not end the session too
+    auto c12{M_DYNAMIC_CAST(MProtocolC12, &proto)};
+    bool endSession{c12 != nullptr && c12->GetEndSessionOnApplicationLayerError()};
+    if (endSession)
+        c12->SetEndSessionOnApplicationLayerError(false);
+    C12::ChunkedRead read{chunkSize};
+    try {
+        for (int count{1}; ; ++count) {
+            auto offset{read.offset()};
+            MByteString chunk;
+            try {
+                Commit(proto, stats, C12::Phase::Read, itemName(itemInt), [&]{
+                    proto.QTableReadPartial(itemInt, static_cast<int>(offset), static_cast<int>(read.size()), count);
+                });
+                chunk = proto.QGetTableData(itemInt, count);
             }
-            if (i == 2) {
-                fieldname = pieces[i].str();
+            catch (MEC12NokResponse&) {
+                if (!read.refused())
+                    throw;
+                break;
             }
+            bool more{read.next(chunk.size())};
+            consume(offset, chunk);
+            if (!more)
+                break;
         }
-    }   
-    for (const auto& t : table) {
-        if (t.Name() == tblname) {
-            return t.valueAsString(fieldname);
+    }
+    catch (...) {
+        if (endSession)
+            c12->SetEndSessionOnApplicationLayerError(true);
+        throw;
+    }
+    if (endSession)
+        c12->SetEndSessionOnApplicationLayerError(true);
+    return read.offset();
+}
+
+unsigned Meter::chunkSize(MProtocol& proto)
+{
+    if (proto.IsPropertyPresent("MAXIMUM_APDU_SIZE_INCOMING"))
+        return C12::c1222ChunkSize(proto.GetProperty("MAXIMUM_APDU_SIZE_INCOMING").AsDWord());
+    if (proto.IsPropertyPresent("PACKET_SIZE") && proto.IsPropertyPresent("MAXIMUM_NUMBER_OF_PACKETS"))
+        return C12::c1218ChunkSize(proto.GetProperty("PACKET_SIZE").AsDWord(), proto.GetProperty("MAXIMUM_NUMBER_OF_PACKETS").AsDWord());
+    return C12::ChunkedRead::defaultChunkSize;
+}
+
+MByteString Meter::tableData(MProtocol& proto, int itemInt, int count)
+{
+    auto it{results.find(count)};
+    return it == results.end() ? proto.QGetTableData(itemInt, count) : it->second;
+}
+
+long Meter::evaluate(const std::string& expression) 
+{
+    try {
+        return evaluate(C12::Expression{expression}).value_or(0);
+    }
+    catch (std::invalid_argument&) {
+        return 0;
+    }
+}
+
+std::optional<long> Meter::evaluate(const C12::Expression& expression) const
+{
+    return expression.evaluate([this](const C12::Reference& ref) { return resolve(ref); });
+}
+
+std::optional<long> Meter::resolve(const C12::Reference& ref) const
+{
+    // a table that was read but lacks the field counts as zero
+    if (auto t = find(ref.table))
+        return C12::resolve(*t, ref);
+    return std::nullopt;
+}
+
+std::string Meter::evaluateAsString(const std::string& expression) const 
+{
+    // TABLE.FIELD
+    auto dot{expression.find('.')};
+    if (dot == std::string::npos)
+        return "";
+    auto t{find(C12::Symbol::find(expression.substr(0, dot)))};
+    return t == nullptr ? "" : t->valueAsString(expression.substr(dot + 1));
+}
+
+C12::Value Meter::value(const std::string& tablename, const std::string& fieldname) const
+{
+    if (auto t = find(C12::Symbol::find(tablename))) {
+        if (auto fld = t->field(fieldname))
+            return fld->typed();
+    }
+    return std::monostate{};
+}
+
+std::vector<int> Meter::tablesUsed() const
+{
+    std::vector<int> numbers;
+    for (auto [fieldname, offset] : {std::pair{"STD_TBLS_USED", 0}, std::pair{"MFG_TBLS_USED", 2048}}) {
+        auto used{value("GEN_CONFIG_TBL", fieldname)};
+        if (auto bits = std::get_if<C12::SetBits>(&used)) {
+            for (auto bit : *bits)
+                numbers.push_back(static_cast<int>(bit) + offset);
         }
     }
-    return "";    
+    return numbers;
+}
+
+std::shared_ptr<const C12::Table> Meter::find(C12::Symbol tablename) const
+{
+    return table.find(tablename);
+}
+
+// the text of a STRING value without the padding, or nothing for other values
+static std::string text(const C12::Value& value)
+{
+    auto bytes{std::get_if<C12::Bytes>(&value)};
+    if (bytes == nullptr)
+        return "";
+    std::string str(bytes->begin(), bytes->end());
+    str.erase(str.find_last_not_of(std::string{" \0", 2}) + 1);
+    return str;
+}
+
+C12::Model Meter::model() const
+{
+    C12::Model m;
+    if (find(C12::Symbol::find("GENERAL_MFG_ID_TBL")) == nullptr)
+        return m;
+    m.manufacturer = text(value("GENERAL_MFG_ID_TBL", "MANUFACTURER"));
+    m.model = text(value("GENERAL_MFG_ID_TBL", "ED_MODEL"));
+    m.firmware = evaluateAsString("GENERAL_MFG_ID_TBL.FW_VERSION_NUMBER") + '.' + evaluateAsString("GENERAL_MFG_ID_TBL.FW_REVISION_NUMBER");
+    return m;
 }
 
 void Meter::interpret(int itemInt, MProtocol& proto, int count) 
 {
-    switch (itemInt) {
-    case 0:
-        {
-            auto ST0{MakeST0(proto.QGetTableData(itemInt, count), *this)};
-            ST0.printTo(std::cout);
-            table.push_back(std::move(ST0));
-        }
-        break;
-    case 1:
-        {
-            auto ST1{MakeST1(proto.QGetTableData(itemInt, count), *this)};
-            ST1.printTo(std::cout);
-            table.push_back(std::move(ST1));
-        }
-        break;
-    case 2:
-        {
-            auto ST2{MakeST2(proto.QGetTableData(itemInt, count), *this)};
-            ST2.printTo(std::cout);
-            table.push_back(std::move(ST2));
-        }
-        break;
-    case 3:
-        {
-            auto ST3{MakeST3(proto.QGetTableData(itemInt, count), *this)};
-            ST3.printTo(std::cout);
-            table.push_back(std::move(ST3));
-        }
-        break;
-    case 5:
-        {
-            auto ST5{MakeST5(proto.QGetTableData(itemInt, count), *this)};
-            ST5.printTo(std::cout);
-            table.push_back(std::move(ST5));
-        }
-        break;
-    case 6:
-        {
-            auto ST6{MakeST6(proto.QGetTableData(itemInt, count), *this)};
-            ST6.printTo(std::cout);
-            table.push_back(std::move(ST6));
-        }
-        break;
-    case 10:
-        {
-            auto ST10{MakeST10(proto.QGetTableData(itemInt, count), *this)};
-            ST10.printTo(std::cout);
-            table.push_back(std::move(ST10));
-        }
-        break;
-    case 11:
-        {
-            auto ST11{MakeST11(proto.QGetTableData(itemInt, count), *this)};
-            ST11.printTo(std::cout);
-            table.push_back(std::move(ST11));
-        }
-        break;
-    case 12:
-        {
-            auto ST12{MakeST12(proto.QGetTableData(itemInt, count), *this)};
-            ST12.printTo(std::cout);
-            table.push_back(std::move(ST12));
-        }
-        break;
-    case 20:
-        {
-            auto ST20{MakeST20(proto.QGetTableData(itemInt, count), *this)};
-            ST20.printTo(std::cout);
-            table.push_back(std::move(ST20));
-        }
-        break;
-    case 21:
-        {
-            auto ST21{MakeST21(proto.QGetTableData(itemInt, count), *this)};
-            ST21.printTo(std::cout);
-            table.push_back(std::move(ST21));
-        }
-        break;
-    case 40:
-        {
-            auto ST40{MakeST40(proto.QGetTableData(itemInt, count), *this)};
-            ST40.printTo(std::cout);
-            table.push_back(std::move(ST40));
-        }
-        break;
-    case 41:
-        {
-            auto ST41{MakeST41(proto.QGetTableData(itemInt, count), *this)};
-            ST41.printTo(std::cout);
-            table.push_back(std::move(ST41));
-        }
-        break;
-    case 50:
-        {
-            auto ST50{MakeST50(proto.QGetTableData(itemInt, count), *this)};
-            ST50.printTo(std::cout);
-            table.push_back(std::move(ST50));
-        }
-        break;
-    case 51:
-        {
-            auto ST51{MakeST51(proto.QGetTableData(itemInt, count), *this)};
-            ST51.printTo(std::cout);
-            table.push_back(std::move(ST51));
-        }
-        break;
-    case 52:
-        {
-            auto ST52{MakeST52(proto.QGetTableData(itemInt, count), *this)};
-            ST52.printTo(std::cout);
-            table.push_back(std::move(ST52));
-        }
-        break;
-    case 55:
-        {
-            auto ST55{MakeST55(proto.QGetTableData(itemInt, count), *this)};
-            ST55.printTo(std::cout);
-            table.push_back(std::move(ST55));
-        }
-        break;
-    case 56:
-        {
-            auto ST56{MakeST56(proto.QGetTableData(itemInt, count), *this)};
-            ST56.printTo(std::cout);
-            table.push_back(std::move(ST56));
-        }
-        break;
-    case 60:
-        {
-            auto ST60{MakeST60(proto.QGetTableData(itemInt, count), *this)};
-            ST60.printTo(std::cout);
-            table.push_back(std::move(ST60));
-        }
-        break;
-    case 61:
-        {
-            auto ST61{MakeST61(proto.QGetTableData(itemInt, count), *this)};
-            ST61.printTo(std::cout);
-            table.push_back(std::move(ST61));
-        }
-        break;
-    case 70:
-        {
-            auto ST70{MakeST70(proto.QGetTableData(itemInt, count), *this)};
-            ST70.printTo(std::cout);
-            table.push_back(std::move(ST70));
-        }
-        break;
-    case 71:
-        {
-            auto ST71{MakeST71(proto.QGetTableData(itemInt, count), *this)};
-            ST71.printTo(std::cout);
-            table.push_back(std::move(ST71));
-        }
-        break;
-    case 72:
-        {
-            auto ST72{MakeST72(proto.QGetTableData(itemInt, count), *this)};
-            ST72.printTo(std::cout);
-            table.push_back(std::move(ST72));
-        }
-        break;
-    case 73:
-        {
-            auto ST73{MakeST73(proto.QGetTableData(itemInt, count), *this)};
-            ST73.printTo(std::cout);
-            table.push_back(std::move(ST73));
-        }
-        break;
-    default:
-        // do nothing
-        break;
+    interpret(itemInt, proto.QGetTableData(itemInt, count));
+}
+
+void Meter::interpret(int itemInt, const std::string& tbldata) 
+{
+    C12::ArenaScope scope{arena.get()};
+    auto builder{builders().find(itemInt, manufacturerSet)};
+    if (builder == nullptr)
+        return;
+    auto tbl{(*builder)(tbldata, *this)};
+    if (itemInt == 0)
+        bigEndianData = tbl.value("FORMAT_CONTROL_1", "DATA_ORDER") != 0;
+    tbl.setDataOrder(bigEndianData);
+    std::shared_ptr<const C12::Table> previous;
+    if (changesOnly)
+        previous = table.find(tbl.Number());
+    if (previous)
+        C12::printChanges(*previous, tbl, out);
+    else
+        tbl.printTo(out);
+    store(std::move(tbl));
+    if (itemInt == 1)
+        manufacturerSet = builders().select(text(value("GENERAL_MFG_ID_TBL", "MANUFACTURER")), text(value("GENERAL_MFG_ID_TBL", "ED_MODEL")));
+}
+
+C12::BuilderRegistry& Meter::builders()
+{
+    static C12::BuilderRegistry registry{[]{
+        C12::BuilderRegistry standard;
+        static const std::pair<unsigned, C12::Table (*)(std::string, Meter&)> tables[]{
+            {0, MakeST0}, {1, MakeST1}, {2, MakeST2}, {3, MakeST3}, {5, MakeST5}, {6, MakeST6},
+            {10, MakeST10}, {11, MakeST11}, {12, MakeST12},
+            {20, MakeST20}, {21, MakeST21}, {23, MakeST23},
+            {40, MakeST40}, {41, MakeST41},
+            {50, MakeST50}, {51, MakeST51}, {52, MakeST52}, {55, MakeST55}, {56, MakeST56},
+            {60, MakeST60}, {61, MakeST61},
+            {70, MakeST70}, {71, MakeST71}, {72, MakeST72}, {73, MakeST73},
+        };
+        for (const auto& [number, make] : tables)
+            standard.add(number, make);
+        return standard;
+    }()};
+    return registry;
+}
+
+void Meter::loadDefinitions(const std::string& fileName)
+{
+    static const std::string suffix{".tdl"};
+    bool tdl{fileName.size() > suffix.size() && std::equal(suffix.rbegin(), suffix.rend(), fileName.rbegin(), 
+        [](char a, char b){ return a == std::tolower(static_cast<unsigned char>(b)); })};
+    if (!tdl) {
+        builders().loadPlugin(fileName);
+        return;
+    }
+    for (auto& def : C12::readTdl(fileName)) {
+        auto builder = [def](std::string tbldata, Meter& meter) {
+            return def.build(tbldata, [&meter](const C12::Reference& ref) { return meter.resolve(ref); }, meter.bigEndian());
+        };
+        if (def.number() < C12::BuilderRegistry::standardTables)
+            builders().add(def.number(), builder);
+        else
+            builders().add(def.manufacturer(), def.model(), def.number(), builder);
     }
 }
 
+void Meter::store(C12::Table&& tbl)
+{
+    // a table read again, as when polling, replaces the earlier copy
+    table.store(std::move(tbl));
+}
+
 void Meter::GetResults(MProtocol& proto, const MStdStringVector& tables)
 {
     int count{0};
     for (const auto& item : tables) {
         ++count;
+        if (streamed.count(count) != 0 || skipped.count(count) != 0)
+            continue;
         auto itemInt{stringToTableNumber(item)};
-        std::cout << item << ":\n"
-            << MUtilities::BytesToHexString(proto.QGetTableData(itemInt, count),
-                                            "  XX XX XX XX  XX XX XX XX  XX XX XX XX  XX XX XX XX\n")
-            << '\n';
-        interpret(itemInt, proto, count);
+        auto data{tableData(proto, itemInt, count)};
+        out << item << ":\n";
+        // the changes of a table read before are printed when it is decoded
+        if (!changesOnly || itemInt < 0 || !table.find(static_cast<unsigned>(itemInt)))
+            out << MUtilities::BytesToHexString(data, hexDumpMask) << '\n';
+        auto allocations{C12::allocationCounters().allocations};
+        auto start{std::chrono::steady_clock::now()};
+        interpret(itemInt, data);
+        if (stats != nullptr) {
+            C12::PhaseSample sample;
+            sample.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            sample.allocations = C12::allocationCounters().allocations - allocations;
+            stats->record(C12::Phase::Decode, item, sample);
+        }
     }
 
     std::stringstream ss;
-    ss << "Device (" << evaluateAsString("GENERAL_MFG_ID_TBL.ED_MODEL") << ") retries: " << linkLayerRetries << '\n';
+    ss << "Device (" << evaluateAsString("GENERAL_MFG_ID_TBL.ED_MODEL") << ") retries: " << linkLayerRetries + linkRetries << '\n';
     proto.WriteToMonitor(ss.str());
+    auto current{std::make_shared<const C12::TableSnapshot>(table, ++sessions)};
+    snapshots.store(current);
+    if (publish)
+        publish(*current);
 }
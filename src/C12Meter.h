@@ -3,16 +3,123 @@
 #include <MCORE/MCOREExtern.h>
 #include <MCOM/MCOM.h>
 #include "C12Tables.h"
+#include "Arena.h"
+#include "ChunkedRead.h"
+#include "Expression.h"
+#include "ReadPlan.h"
+#include "Schedule.h"
+#include "SessionStats.h"
+#include "TableBuilders.h"
+#include "TableRegistry.h"
+#include "TableSnapshot.h"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
 
 class Meter {
 public:
+    // makes a protocol owning a channel of its own, for one request in flight
+    using LinkFactory = std::function<std::unique_ptr<MProtocol>()>;
+    // receives each part of a table read in chunks, with its offset in the table
+    using ChunkConsumer = std::function<void(std::size_t offset, const MByteString& chunk)>;
+    // receives the tables read so far once the results of a session are decoded
+    using Publisher = std::function<void(const C12::TableSnapshot& tables)>;
+    explicit Meter(std::ostream& out = std::cout) : out{out} {}
     void Communicate(MProtocol& proto, const MStdStringVector& tables);
     void GetResults(MProtocol& proto, const MStdStringVector& tables);
+    // the value of an expression over the tables read so far, or 0
     long evaluate(const std::string& expression);
+    // nothing if the expression refers to a table that was not read
+    std::optional<long> evaluate(const C12::Expression& expression) const;
+    // the value a reference names, or nothing if its table was not read
+    std::optional<long> resolve(const C12::Reference& ref) const;
     std::string evaluateAsString(const std::string& expression) const;
+    // the decoded value of a field, or std::monostate if it was not read
+    C12::Value value(const std::string& tablename, const std::string& fieldname) const;
+    // tables GEN_CONFIG_TBL lists as used, with manufacturer tables from 2048
+    std::vector<int> tablesUsed() const;
+    // what GENERAL_MFG_ID_TBL says this meter is, empty until it is read
+    C12::Model model() const;
+    // the data order GEN_CONFIG_TBL gives, little-endian until it is read
+    bool bigEndian() const { return bigEndianData; }
     void interpret(int itemInt, MProtocol& proto, int count);
+    // reads a table in partial reads of chunkSize bytes, handing each to
+    // consume as it arrives, and returns the size of the table
+    std::size_t readChunked(MProtocol& proto, int itemInt, unsigned chunkSize, const ChunkConsumer& consume);
+    // the largest partial read a response of the protocol can carry
+    static unsigned chunkSize(MProtocol& proto);
+    // when set, tables are read in chunks and those without a layout are
+    // printed as each chunk arrives rather than kept whole
+    void setChunked(bool on) { chunked = on; }
+    // when set, a table read before is printed as only the fields that changed since
+    void setChangesOnly(bool on) { changesOnly = on; }
+    // when the window is over 1, table reads are sessionless requests with
+    // up to window of them in flight at once, each on a link of its own
+    void setPipeline(LinkFactory factory, unsigned window) { makeLink = std::move(factory); pipelineWindow = window; }
+    // link layer retries of the window's links, which the protocol does not count
+    unsigned pipelineRetries() const { return linkRetries; }
+    // when set, each item is read in a request of its own, highest priority first
+    void setPriorities(const C12::Priorities& order) { priorities = order; }
+    // when not zero, reads stop this long after a session starts, leaving the rest unread
+    void setDeadline(std::chrono::milliseconds afterStart) { deadline = afterStart; }
+    // the items of the last session which the deadline left unread, in the given order
+    MStdStringVector unread() const;
+    void interpret(int itemInt, const std::string& tbldata);
+    // when set, each phase of a session is committed and timed separately
+    void setStatistics(C12::SessionStats* sessionStats) { stats = sessionStats; }
+    C12::SessionStats* statistics() const { return stats; }
+    void setPublisher(Publisher publisher) { publish = std::move(publisher); }
+    // when set, tables are built in an arena which is only released with
+    // the Meter, so this suits single reads rather than polling
+    void useArena() { if (!arena) arena = std::make_unique<C12::Arena>(); }
+    // the tables decoded so far, each replaced when it is read again
+    const C12::TableRegistry& tables() const { return table; }
+    // the tables as of the last completed session, which other threads
+    // can use while the next session is read
+    std::shared_ptr<const C12::TableSnapshot> snapshot() const { return snapshots.load(); }
+    // bounds the table data kept, evicting the least recently used tables
+    void limitTables(std::size_t maxBytes) { table.setLimit(maxBytes); }
+    // shared by every Meter, with the standard tables already registered
+    static C12::BuilderRegistry& builders();
+    // adds the tables of a TDL file, or of a plugin unless the name ends in .tdl
+    static void loadDefinitions(const std::string& fileName);
+    // true once Ctrl-C has been pressed outside of a meter read
+    static bool interrupted();
+    // true if the item names a table, such as ST23, MT2 or 2050, rather than a function
+    static bool isTable(const std::string& item);
+    // the item name of a table number, as used on the command line
+    static std::string itemName(int itemInt);
 private:
-    std::vector<C12::Table> table = {};
+    void store(C12::Table&& tbl);
+    std::shared_ptr<const C12::Table> find(C12::Symbol tablename) const;
+    void CommunicateTimed(MProtocol& proto, const MStdStringVector& tables);
+    void CommunicateChunked(MProtocol& proto, const MStdStringVector& tables);
+    void CommunicatePipelined(const MStdStringVector& tables);
+    void CommunicatePrioritized(MProtocol& proto, const MStdStringVector& tables);
+    MByteString tableData(MProtocol& proto, int itemInt, int count);
+    std::ostream& out;
+    C12::SessionStats* stats = nullptr;
+    std::map<int, MByteString> results = {};
+    std::set<int> streamed = {};                // printed while they were read
+    std::optional<C12::Priorities> priorities = {};
+    std::chrono::milliseconds deadline{0};
+    std::map<int, MStdString> skipped = {};     // left unread by the deadline
+    bool chunked = false;
+    bool changesOnly = false;
+    LinkFactory makeLink = {};
+    Publisher publish = {};
+    unsigned pipelineWindow = 1;
+    unsigned linkRetries = 0;                   // of the window's links, each gone once it is done
+    const C12::BuilderSet* manufacturerSet = nullptr;   // chosen once ST1 is read
+    bool bigEndianData = false;                 // data order given by ST0
+    std::unique_ptr<C12::Arena> arena = {};     // must outlive the tables
+    C12::TableRegistry table{};
+    C12::SnapshotCell snapshots{};
+    std::uint64_t sessions = 0;
 };
 
 #endif // C12METER_H
@@ -1,22 +1,18 @@
 #include "C12Tables.h"
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <iomanip>
 #include <iostream>
 #include <numeric>
 #include <sstream>
 
-static bool global_big_endian{false};
-
 namespace C12 {
 
-    bool setDataOrder(bool big_endian) {
-        return global_big_endian = big_endian;
-    }
-
-    static unsigned ReadUnsigned(const uint8_t* dataptr, std::size_t len, bool big_endian) {
+    static unsigned ReadUnsigned(TableData data, std::size_t len) {
+        auto dataptr{data.bytes()};
         unsigned value{ 0 };
-        if (big_endian) {
+        if (data.bigEndian()) {
             for (std::size_t i{ 0 }; i < len; ++i) {
                 value = (value << 8) | *dataptr++;
             }
@@ -30,12 +26,32 @@ namespace C12 {
         return value;
     }
 
-    std::string Field::to_string(const uint8_t* tabledata) const {
+    // each field remembers the resource it came from just ahead of the object
+    static constexpr std::size_t fieldHeader{alignof(std::max_align_t)};
+
+    void* Field::operator new(std::size_t size) {
+        auto resource{tableResource()};
+        auto p{static_cast<char*>(resource->allocate(size + fieldHeader, alignof(std::max_align_t)))};
+        *reinterpret_cast<std::pmr::memory_resource**>(p) = resource;
+        return p + fieldHeader;
+    }
+
+    void Field::operator delete(void* ptr, std::size_t size) {
+        auto p{static_cast<char*>(ptr) - fieldHeader};
+        auto resource{*reinterpret_cast<std::pmr::memory_resource**>(p)};
+        resource->deallocate(p, size + fieldHeader, alignof(std::max_align_t));
+    }
+
+    std::string Field::to_string(TableData tabledata) const {
         std::stringstream ss;
         printTo(tabledata, ss);
         return ss.str();
     }
 
+    Value Field::typed(TableData tabledata) const {
+        return FieldRef{ *this, tabledata };
+    }
+
     UINT::UINT(std::string name, std::size_t offset, std::size_t len)
         : name{ name }
         , offset{ offset }
@@ -43,19 +59,23 @@ namespace C12 {
     {
     }
 
-    unsigned UINT::operator()(const uint8_t* tabledata) const {
-        return ReadUnsigned(tabledata + offset, len, global_big_endian);
+    unsigned UINT::operator()(TableData tabledata) const {
+        return ReadUnsigned(tabledata + offset, len);
     }
 
-    std::ostream& UINT::printTo(const uint8_t* tabledata, std::ostream& out) const {
+    std::ostream& UINT::printTo(TableData tabledata, std::ostream& out) const {
         return out << operator()(tabledata);
     }
 
     // we define a more efficient version of to_string() for UINT
-    std::string UINT::to_string(const uint8_t* tabledata) const {
+    std::string UINT::to_string(TableData tabledata) const {
         return std::to_string(operator()(tabledata));
     }
 
+    Value UINT::typed(TableData tabledata) const {
+        return static_cast<unsigned long>(operator()(tabledata));
+    }
+
     BINARY::BINARY(std::string name, std::size_t offset, std::size_t len)
         : name{ name }
         , offset{ offset }
@@ -63,22 +83,26 @@ namespace C12 {
     {
     }
 
-    std::vector<uint8_t> BINARY::operator()(const uint8_t* tabledata) const {
+    std::vector<uint8_t> BINARY::operator()(TableData tabledata) const {
         std::vector<uint8_t> v;
         v.reserve(len);
-        std::copy(tabledata + offset, tabledata + offset + len, v.begin());
+        std::copy(tabledata.bytes() + offset, tabledata.bytes() + offset + len, v.begin());
         return v;
     }
 
-    unsigned BINARY::value(const uint8_t* tabledata, std::size_t index) const {
+    unsigned BINARY::value(TableData tabledata, std::size_t index) const {
         return tabledata[offset + index];
     };
 
-    std::ostream& BINARY::printTo(const uint8_t* tabledata, std::ostream& out) const {
-        tabledata += offset;
+    Value BINARY::typed(TableData tabledata) const {
+        return Bytes{ tabledata.bytes() + offset, len };
+    }
+
+    std::ostream& BINARY::printTo(TableData tabledata, std::ostream& out) const {
+        auto bytes{ tabledata.bytes() + offset };
         out << "\"";
         for (auto count{ len }; count; --count)
-            out << static_cast<char>(*tabledata++);
+            out << static_cast<char>(*bytes++);
         return out << "\"";
     }
 
@@ -92,26 +116,30 @@ namespace C12 {
 #define DUMP(x) std::cout << #x " = " << x << '\n'
 
     // we define a more efficient version of to_string() for STRING
-    std::string STRING::to_string(const uint8_t* tabledata) const {
-        return "\"" + std::string{tabledata + offset, tabledata + offset + len} + "\"";
+    std::string STRING::to_string(TableData tabledata) const {
+        return "\"" + std::string{tabledata.bytes() + offset, tabledata.bytes() + offset + len} + "\"";
     }
 
-    std::vector<uint8_t> STRING::operator()(const uint8_t* tabledata) const {
+    std::vector<uint8_t> STRING::operator()(TableData tabledata) const {
         std::vector<uint8_t> v;
         v.reserve(len);
-        std::copy(tabledata + offset, tabledata + offset + len, v.begin());
+        std::copy(tabledata.bytes() + offset, tabledata.bytes() + offset + len, v.begin());
         return v;
     }
 
-    unsigned STRING::value(const uint8_t* tabledata, std::size_t index) const {
+    unsigned STRING::value(TableData tabledata, std::size_t index) const {
         return tabledata[offset + index];
     };
 
-    std::ostream& STRING::printTo(const uint8_t* tabledata, std::ostream& out) const {
-        tabledata += offset;
+    Value STRING::typed(TableData tabledata) const {
+        return Bytes{ tabledata.bytes() + offset, len };
+    }
+
+    std::ostream& STRING::printTo(TableData tabledata, std::ostream& out) const {
+        auto bytes{ tabledata.bytes() + offset };
         out << "\"";
         for (auto count{ len }; count; --count)
-            out << static_cast<char>(*tabledata++);
+            out << static_cast<char>(*bytes++);
         return out << "\"";
     }
 
@@ -122,32 +150,33 @@ namespace C12 {
     {
     }
 
-    std::vector<bool> SET::operator()(const uint8_t* tabledata) const {
+    std::vector<bool> SET::operator()(TableData tabledata) const {
         std::vector<bool> v;
-        tabledata += offset;
-        auto end = tabledata + len;
+        auto bytes{ tabledata.bytes() + offset };
+        auto end = bytes + len;
         v.reserve(len * 8);
-        for (auto count{ len }; tabledata < end; ++tabledata) {
+        for (auto count{ len }; bytes < end; ++bytes) {
             for (uint8_t mask{ 1u }; mask; mask <<= 1) {
-                v.push_back(*tabledata & mask);
+                v.push_back(*bytes & mask);
             }
         }
         return v;
     }
 
-    std::ostream& SET::printTo(const uint8_t* tabledata, std::ostream& out) const {
-        auto bset{ operator()(tabledata) };
+    std::ostream& SET::printTo(TableData tabledata, std::ostream& out) const {
         out << "{ ";
-        for (std::size_t i{ 0 }; i < bset.size(); ++i) {
-            if (bset[i]) {
-                out << i << ' ';
-            }
+        for (auto bit : SetBits{ tabledata.bytes() + offset, len }) {
+            out << bit << ' ';
         }
         return out << "}";
     }
-    unsigned SET::value(const uint8_t* tabledata, std::size_t index) const {
-        auto bset{ operator()(tabledata) };
-        return bset[index];
+    unsigned SET::value(TableData tabledata, std::size_t index) const {
+        // bits past the end of the set are simply not set
+        return SetBits{ tabledata.bytes() + offset, len }.test(index);
+    }
+
+    Value SET::typed(TableData tabledata) const {
+        return SetBits{ tabledata.bytes() + offset, len };
     }
 
     BITFIELD::BITFIELD(std::string name, std::size_t offset, std::size_t len)
@@ -157,18 +186,19 @@ namespace C12 {
     {
     }
 
-    std::ostream& BITFIELD::printTo(const uint8_t* tabledata, std::ostream& out) const {
+    std::ostream& BITFIELD::printTo(TableData tabledata, std::ostream& out) const {
         out << "{\n";
         for (const auto& sub : subfields) {
-            out << "\t" << sub.Name() << " = " << sub(ReadUnsigned(tabledata + offset, len, global_big_endian)) << '\n';
+            out << "\t" << sub.Name() << " = " << sub(ReadUnsigned(tabledata + offset, len)) << '\n';
         }
         return out << "    }";
     }
 
-    unsigned BITFIELD::value(const uint8_t* tabledata, const std::string& subfieldname) const {
+    unsigned BITFIELD::value(TableData tabledata, const std::string& subfieldname) const {
+        auto sym{Symbol::find(subfieldname)};
         for (const auto& sub : subfields) {
-            if (sub.Name() == subfieldname) {
-                return sub(ReadUnsigned(tabledata + offset, len, global_big_endian));
+            if (sub.symbol() == sym) {
+                return sub(ReadUnsigned(tabledata + offset, len));
             }
         }
         return 0;
@@ -181,9 +211,6 @@ namespace C12 {
     {}
 
     unsigned BITFIELD::Subfield::operator()(unsigned fielddata) const {
-        if (name == "DATA_ORDER") {
-            global_big_endian = (fielddata >> shift) & mask;
-        }
         return (fielddata >> shift) & mask;
     }
 
@@ -213,27 +240,80 @@ namespace C12 {
             rec = std::make_unique<BITFIELD>(name, 0, fieldsize);
             break;
         }
+        stride = rec ? rec->size() : 0;
     }
 
-    unsigned ARRAY::value(const uint8_t *tabledata, std::size_t index) const {
-        return rec->value(tabledata + offset + index * rec->size());
+    ARRAY::ARRAY(std::string name, std::size_t offset, std::shared_ptr<const Record> layout, std::size_t count)
+        : name{ name }
+        , offset{ offset }
+        , count{ count }
+        , rec{ std::make_unique<RECORD>(name, 0, layout) }
+        , stride{ layout->recordSize() }
+    {
+    }
+
+    unsigned ARRAY::value(TableData tabledata, std::size_t index) const {
+        return rec->value(tabledata + offset + index * stride);
     }
 
-    std::ostream& ARRAY::printTo(const uint8_t* tabledata, std::ostream& out) const {
+    unsigned ARRAY::value(TableData tabledata, std::size_t index, const std::string& membername) const {
+        return rec->value(tabledata + offset + index * stride, membername);
+    }
+
+    const Field* ARRAY::element(TableData& tabledata, std::size_t index) const {
+        if (index >= count)
+            return nullptr;
+        tabledata += offset + index * stride;
+        return rec.get();
+    }
+
+    std::ostream& ARRAY::printTo(TableData tabledata, std::ostream& out) const {
         for (std::size_t i{0}; i < count; ++i) {
             out << "\n    " << Name() << "[" << i << "] = ";
-            rec->printTo(tabledata + i * rec->size(), out);
+            rec->printTo(tabledata + offset + i * stride, out);
         }
         return out << '\n';
     }
 
-    std::unique_ptr<Field> ARRAY::clone() const {
-        // TODO: recreate whatever rec is pointing to
-        return std::unique_ptr<Field>(new ARRAY(name, offset, Record::fieldtype::STRING, 0, 0));
+    ARRAY::ARRAY(const ARRAY& other)
+        : name{ other.name }
+        , offset{ other.offset }
+        , count{ other.count }
+        , rec{ other.rec ? other.rec->clone() : nullptr }
+        , stride{ other.stride }
+    {
     }
 
-    Record::Record(std::string name) 
+    RECORD::RECORD(std::string name, std::size_t offset, std::shared_ptr<const Record> layout)
         : name{ name }
+        , offset{ offset }
+        , layout{ layout }
+    {
+    }
+
+    std::ostream& RECORD::printTo(TableData tabledata, std::ostream& out) const {
+        out << "{";
+        for (const auto& fld : *layout) {
+            out << "\n\t" << fld->Name() << " = ";
+            fld->printTo(tabledata + offset, out);
+        }
+        return out << "\n    }";
+    }
+
+    unsigned RECORD::value(TableData tabledata, const std::string& membername) const {
+        return layout->value(tabledata + offset, membername);
+    }
+
+    const Field* RECORD::member(TableData& tabledata, const std::string& membername) const {
+        auto fld{layout->find(membername)};
+        if (fld)
+            tabledata += offset;
+        return fld;
+    }
+
+    Record::Record(std::string name) 
+        : std::pmr::vector<std::unique_ptr<Field>>{ tableResource() }
+        , name{ name }
     {
     }
 
@@ -242,7 +322,7 @@ namespace C12 {
         : Record{ recordname }
         , num{ number }
         , name{ name }
-        , data{ data.begin(), data.end() }
+        , data{ data.begin(), data.end(), tableResource() }
     {
     }
 
@@ -250,7 +330,7 @@ namespace C12 {
         : Record{ recordname }
         , num{ number }
         , name{ name }
-        , data{ data.begin(), data.end() }
+        , data{ data.begin(), data.end(), tableResource() }
     {
     }
 
@@ -279,59 +359,96 @@ namespace C12 {
         return totalsize += fieldsize * arraysize;
     }
 
+    std::size_t Record::addField(std::string name, std::shared_ptr<const Record> layout) {
+        emplace_back(std::make_unique<RECORD>(name, totalsize, layout));
+        return totalsize += layout->recordSize();
+    }
+
+    std::size_t Record::addField(std::string name, std::shared_ptr<const Record> layout, std::size_t arraysize) {
+        emplace_back(std::make_unique<ARRAY>(name, totalsize, layout, arraysize));
+        return totalsize += layout->recordSize() * arraysize;
+    }
+
     std::ostream& Record::printTo(const std::string& str, std::ostream& out) const {
         return printTo(reinterpret_cast<const uint8_t*>(str.data()), out);
     }
 
-    std::size_t Record::value(const uint8_t* tabledata, const std::string& fieldname) const {
-        // find the field
+    Field* Record::find(const std::string& fieldname) const {
+        // a name that was never interned cannot belong to any field
+        auto sym{Symbol::find(fieldname)};
+        return sym ? find(sym) : nullptr;
+    }
+
+    Field* Record::find(Symbol fieldname) const {
         for (const auto& fld : *this) {
-            if (fld->Name() == fieldname) {
-                return fld->value(tabledata);
+            if (fld->symbol() == fieldname) {
+                return fld.get();
             }
         }
-        return 0;
+        return nullptr;
+    }
+
+    std::size_t Record::value(TableData tabledata, const std::string& fieldname) const {
+        auto fld{find(fieldname)};
+        return fld ? fld->value(tabledata) : 0;
     }
 
     std::size_t Table::value(const std::string& fieldname) const {
-        // find the field
-        for (const auto& fld : *this) {
-            if (fld->Name() == fieldname) {
-                return fld->value(static_cast<const uint8_t *>(data.data()));
-            }
-        }
-        return 0;
+        auto fld{find(fieldname)};
+        return fld ? fld->value(tabledata()) : 0;
     }
 
     std::size_t Table::value(const std::string& fieldname, const std::size_t index) const {
-        for (const auto& fld : *this) {
-            if (fld->Name() == fieldname) {
-                return fld->value(static_cast<const uint8_t *>(data.data()), index);
-            }
-        }
-        return 0;
+        auto fld{find(fieldname)};
+        return fld ? fld->value(tabledata(), index) : 0;
     }
 
     std::size_t Table::value(const std::string& fieldname, const std::string& subfieldname) const {
-        for (const auto& fld : *this) {
-            if (fld->Name() == fieldname) {
-                return fld->value(static_cast<const uint8_t *>(data.data()), subfieldname);
-            }
-        }
-        return 0;
+        auto fld{find(fieldname)};
+        return fld ? fld->value(tabledata(), subfieldname) : 0;
+    }
+
+    std::size_t Table::value(const std::string& fieldname, std::size_t index, const std::string& membername) const {
+        auto fld{find(fieldname)};
+        return fld ? fld->value(tabledata(), index, membername) : 0;
     }
 
     std::string Table::valueAsString(const std::string& fieldname) const {
-        // find the field
-        for (const auto& fld : *this) {
-            if (fld->Name() == fieldname) {
-                return fld->to_string(static_cast<const uint8_t *>(data.data()));
-            }
+        auto fld{find(fieldname)};
+        return fld ? fld->to_string(tabledata()) : "";
+    }
+
+    std::optional<FieldRef> Table::field(const std::string& fieldname) const {
+        if (auto fld = find(fieldname)) {
+            return FieldRef{*fld, tabledata()};
+        }
+        return std::nullopt;
+    }
+
+    std::optional<FieldRef> Table::field(Symbol fieldname) const {
+        if (auto fld = find(fieldname)) {
+            return FieldRef{*fld, tabledata()};
+        }
+        return std::nullopt;
+    }
+
+    std::optional<FieldRef> FieldRef::element(std::size_t index) const {
+        auto base{tabledata};
+        if (auto fld = this->fld->element(base, index)) {
+            return FieldRef{*fld, base};
+        }
+        return std::nullopt;
+    }
+
+    std::optional<FieldRef> FieldRef::member(const std::string& membername) const {
+        auto base{tabledata};
+        if (auto fld = this->fld->member(base, membername)) {
+            return FieldRef{*fld, base};
         }
-        return "";
+        return std::nullopt;
     }
 
-    std::ostream& Record::printTo(const uint8_t* tabledata, std::ostream& out) const {
+    std::ostream& Record::printTo(TableData tabledata, std::ostream& out) const {
         for (const auto& fld : *this) {
             out << "\n    " << fld->Name() << " = ";
             fld->printTo(tabledata, out);
@@ -340,15 +457,17 @@ namespace C12 {
     }
 
     std::ostream& Table::printTo(std::ostream& out) const {
-        out << "TABLE " << num << ' ' << name;
-        return Record::printTo(data.data(), out);
+        out << "TABLE " << num << ' ' << name.str();
+        // layouts sized from other tables can outgrow what the meter sent
+        if (recordSize() > data.size()) {
+            return out << "\n    " << data.size() << " bytes read but the layout needs " << recordSize() << '\n';
+        }
+        return Record::printTo(tabledata(), out);
     }
 
     std::optional<std::unique_ptr<Field>> Record::operator[](const std::string& fieldname) const {
-        for (const auto& fld : *this) {
-            if (fld->Name() == fieldname) {
-                return std::optional<std::unique_ptr<Field>>{fld->clone()};
-            }
+        if (auto fld = find(fieldname)) {
+            return std::optional<std::unique_ptr<Field>>{fld->clone()};
         }
         return std::nullopt;
     }
@@ -358,11 +477,8 @@ namespace C12 {
     }
 
     void Record::addSubfield(const std::string& fieldname, std::string subfieldname, unsigned startbit, unsigned endbit) {
-        for (const auto& fld : *this) {
-            if (fld->Name() == fieldname) {
-                fld->addSubfield(subfieldname, startbit, endbit);
-                return;
-            }
+        if (auto fld = find(fieldname)) {
+            fld->addSubfield(subfieldname, startbit, endbit);
         }
     }
 
@@ -6,91 +6,181 @@
 #include <vector>
 #include <iostream>
 #include <initializer_list>
+#include <iterator>
+#include <memory_resource>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <variant>
+#include "Arena.h"
+#include "Symbol.h"
 
 namespace C12 {
 
-    bool setDataOrder(bool big_endian);
+    /* 
+     * The numbers of the bits set in a SET field, in increasing order.
+     * Bit N is bit N % 8 of byte N / 8, read in place from the table.
+     */
+    class SetBits {
+    public:
+        SetBits(const uint8_t* data, std::size_t len) : data{data}, len{len} {}
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::size_t*;
+            using reference = std::size_t;
+            iterator(const SetBits& bits, std::size_t bit) : bits{&bits}, bit{bit} { skip(); }
+            std::size_t operator*() const { return bit; }
+            iterator& operator++() { ++bit; skip(); return *this; }
+            iterator operator++(int) { auto was{*this}; ++*this; return was; }
+            bool operator==(const iterator& other) const { return bit == other.bit; }
+            bool operator!=(const iterator& other) const { return bit != other.bit; }
+        private:
+            void skip() { while (bit < bits->capacity() && !bits->test(bit)) ++bit; }
+            const SetBits* bits;
+            std::size_t bit;
+        };
+        iterator begin() const { return iterator{*this, 0}; }
+        iterator end() const { return iterator{*this, capacity()}; }
+        // number of bits the set can hold
+        std::size_t capacity() const { return len * 8; }
+        bool test(std::size_t bit) const { return bit < capacity() && (data[bit / 8] >> (bit % 8) & 1); }
+    private:
+        const uint8_t* data;
+        std::size_t len;
+    };
+
+    class FieldRef;
+    using Bytes = std::basic_string_view<uint8_t>;
+
+    /*
+     * The table data a field is decoded from, and the byte order of its
+     * integers.  FORMAT_CONTROL_1.DATA_ORDER of GEN_CONFIG_TBL gives the
+     * order for every table of a meter; without it data is little-endian.
+     */
+    class TableData {
+    public:
+        TableData(const uint8_t* bytes, bool bigEndian = false) : ptr{bytes}, big{bigEndian} {}
+        const uint8_t* bytes() const { return ptr; }
+        bool bigEndian() const { return big; }
+        uint8_t operator[](std::size_t index) const { return ptr[index]; }
+        TableData operator+(std::size_t offset) const { return TableData{ptr + offset, big}; }
+        TableData& operator+=(std::size_t offset) { ptr += offset; return *this; }
+    private:
+        const uint8_t* ptr;
+        bool big;
+    };
+
+    /*
+     * A decoded value without conversion to text: nothing, an integer,
+     * the bytes of a BINARY or STRING, the bits of a SET, or a view of
+     * a BITFIELD, RECORD or ARRAY to look further into.  Everything but
+     * the integer refers to the table data it came from.
+     */
+    using Value = std::variant<std::monostate, unsigned long, Bytes, SetBits, FieldRef>;
 
+    /*
+     * Fields are allocated from the table resource of the thread that
+     * creates them, which is an arena while a Meter using one decodes.
+     */
     struct Field {
-        virtual std::string Name() const = 0;
-        virtual std::ostream& printTo(const uint8_t* tabledata, std::ostream& out) const = 0;
-        virtual unsigned value(const uint8_t*) const { return 0; }
-        virtual unsigned value(const uint8_t*, std::size_t) const { return 0; }
-        virtual unsigned value(const uint8_t*, const std::string&) const { return 0; }
+        virtual ~Field() = default;
+        static void* operator new(std::size_t size);
+        static void operator delete(void* ptr, std::size_t size);
+        virtual const std::string& Name() const = 0;
+        virtual Symbol symbol() const = 0;
+        virtual std::ostream& printTo(TableData tabledata, std::ostream& out) const = 0;
+        virtual unsigned value(TableData) const { return 0; }
+        virtual unsigned value(TableData, std::size_t) const { return 0; }
+        virtual unsigned value(TableData, const std::string&) const { return 0; }
+        virtual unsigned value(TableData, std::size_t, const std::string&) const { return 0; }
         virtual std::size_t size() const = 0;
         virtual std::unique_ptr<Field> clone() const = 0;
         virtual void addSubfield(std::string, unsigned, unsigned) {}
-        virtual std::string to_string(const uint8_t* tabledata) const;
+        virtual std::string to_string(TableData tabledata) const;
+        // element of an array or member of a record, moving tabledata to where it is based
+        virtual const Field* element(TableData&, std::size_t) const { return nullptr; }
+        virtual const Field* member(TableData&, const std::string&) const { return nullptr; }
+        // a view of the field unless it has a simpler type
+        virtual Value typed(TableData tabledata) const;
     };
 
     class UINT : public Field {
     public:
-        std::string Name() const override { return name; }
+        const std::string& Name() const override { return name.str(); }
+        Symbol symbol() const override { return name; }
         UINT(std::string name, std::size_t offset, std::size_t len = 1);
-        unsigned operator()(const uint8_t* tabledata) const;
-        std::ostream& printTo(const uint8_t* tabledata, std::ostream& out) const override;
-        unsigned value(const uint8_t* tbldata) const override { return operator()(tbldata); }
+        unsigned operator()(TableData tabledata) const;
+        std::ostream& printTo(TableData tabledata, std::ostream& out) const override;
+        unsigned value(TableData tbldata) const override { return operator()(tbldata); }
         std::size_t size() const override { return len; }
         std::unique_ptr<Field> clone() const override {
             return std::unique_ptr<Field>(new UINT{ *this });
         }
-        std::string to_string(const uint8_t* tabledata) const override;
+        Value typed(TableData tabledata) const override;
+        std::string to_string(TableData tabledata) const override;
     private:
-        std::string name;
+        Symbol name;
         std::size_t offset;
         std::size_t len;
     };
 
     class BINARY : public Field {
     public:
-        std::string Name() const override { return name; }
+        const std::string& Name() const override { return name.str(); }
+        Symbol symbol() const override { return name; }
         BINARY(std::string name, std::size_t offset, std::size_t len = 1);
-        std::vector<uint8_t> operator()(const uint8_t* tabledata) const;
-        std::ostream& printTo(const uint8_t* tabledata, std::ostream& out) const override;
-        unsigned value(const uint8_t* tabledata, std::size_t index) const override;
+        std::vector<uint8_t> operator()(TableData tabledata) const;
+        std::ostream& printTo(TableData tabledata, std::ostream& out) const override;
+        unsigned value(TableData tabledata, std::size_t index) const override;
         std::size_t size() const override { return len; }
         std::unique_ptr<Field> clone() const override {
             return std::unique_ptr<Field>(new BINARY{ *this });
         }
+        Value typed(TableData tabledata) const override;
     private:
-        std::string name;
+        Symbol name;
         std::size_t offset;
         std::size_t len;
     };
 
     class STRING : public Field {
     public:
-        std::string Name() const override { return name; }
+        const std::string& Name() const override { return name.str(); }
+        Symbol symbol() const override { return name; }
         STRING(std::string name, std::size_t offset, std::size_t len = 1);
-        std::vector<uint8_t> operator()(const uint8_t* tabledata) const;
-        std::ostream& printTo(const uint8_t* tabledata, std::ostream& out) const override;
-        unsigned value(const uint8_t* tabledata, std::size_t index) const override;
+        std::vector<uint8_t> operator()(TableData tabledata) const;
+        std::ostream& printTo(TableData tabledata, std::ostream& out) const override;
+        unsigned value(TableData tabledata, std::size_t index) const override;
         std::size_t size() const override { return len; }
         std::unique_ptr<Field> clone() const override {
             return std::unique_ptr<Field>(new STRING{ *this });
         }
-        std::string to_string(const uint8_t* tabledata) const override;
+        Value typed(TableData tabledata) const override;
+        std::string to_string(TableData tabledata) const override;
     private:
-        std::string name;
+        Symbol name;
         std::size_t offset;
         std::size_t len;
     };
 
     class SET : public Field {
     public:
-        std::string Name() const override { return name; }
+        const std::string& Name() const override { return name.str(); }
+        Symbol symbol() const override { return name; }
         SET(std::string name, std::size_t offset, std::size_t len = 1);
-        std::vector<bool> operator()(const uint8_t* tabledata) const;
-        std::ostream& printTo(const uint8_t* tabledata, std::ostream& out) const override;
-        unsigned value(const uint8_t* tabledata, std::size_t index) const override;
+        std::vector<bool> operator()(TableData tabledata) const;
+        std::ostream& printTo(TableData tabledata, std::ostream& out) const override;
+        unsigned value(TableData tabledata, std::size_t index) const override;
         std::size_t size() const override { return len; }
         std::unique_ptr<Field> clone() const override {
             return std::unique_ptr<Field>(new SET{ *this });
         }
+        Value typed(TableData tabledata) const override;
     private:
-        std::string name;
+        Symbol name;
         std::size_t offset;
         std::size_t len;
     };
@@ -98,11 +188,12 @@ namespace C12 {
     /* a bitfield is a collection of named subfields */
     class BITFIELD : public Field {
     public:
-        std::string Name() const override { return name; }
+        const std::string& Name() const override { return name.str(); }
+        Symbol symbol() const override { return name; }
         BITFIELD(std::string name, std::size_t offset, std::size_t len = 1);
-        std::ostream& printTo(const uint8_t* tabledata, std::ostream& out) const override;
+        std::ostream& printTo(TableData tabledata, std::ostream& out) const override;
         std::size_t size() const override { return len; }
-        unsigned value(const uint8_t* tabledata, const std::string& subfieldname) const override;
+        unsigned value(TableData tabledata, const std::string& subfieldname) const override;
         std::unique_ptr<Field> clone() const override {
             return std::unique_ptr<Field>(new BITFIELD{ *this });
         }
@@ -110,56 +201,131 @@ namespace C12 {
         class Subfield {
         public:
             Subfield(std::string name, unsigned startbit, unsigned endbit);
-            std::string Name() const { return name; }
+            const std::string& Name() const { return name.str(); }
+            Symbol symbol() const { return name; }
             unsigned operator()(unsigned fielddata) const;
+            unsigned StartBit() const { return shift; }
+            unsigned EndBit() const { return shift + static_cast<unsigned>(std::bitset<32>(mask).count()) - 1; }
         private:
-            std::string name;
+            Symbol name;
             unsigned shift;
             unsigned mask;
         };
         void addSubfield(std::string name, unsigned startbit, unsigned endbit) override;
+        const std::pmr::vector<Subfield>& Subfields() const { return subfields; }
     private:
-        std::string name;
+        Symbol name;
         std::size_t offset;
         std::size_t len;
-        std::vector<Subfield> subfields;
+        std::pmr::vector<Subfield> subfields{tableResource()};
     };
 
-    class Record : public std::vector<std::unique_ptr<Field>> {
+    class Record : public std::pmr::vector<std::unique_ptr<Field>> {
     public:
         enum class fieldtype { UINT, SET, BINARY, STRING, BITFIELD, ARRAY };
         Record(std::string name);
-        virtual std::string Name() const { return name; }
+        virtual const std::string& Name() const { return name.str(); }
         std::size_t addField(std::string name, fieldtype type, std::size_t fieldsize);
         std::size_t addField(std::string name, fieldtype type, std::size_t fieldsize, std::size_t arraysize);
+        // a nested record, or an array of them, sharing one layout
+        std::size_t addField(std::string name, std::shared_ptr<const Record> layout);
+        std::size_t addField(std::string name, std::shared_ptr<const Record> layout, std::size_t arraysize);
+        // size in bytes of the record as laid out so far
+        std::size_t recordSize() const { return totalsize; }
         std::ostream& printTo(const std::string& str, std::ostream& out) const;
-        std::ostream& printTo(const uint8_t* tabledata, std::ostream& out) const;
-        std::size_t value(const uint8_t* tabledata, const std::string& fieldname) const;
+        std::ostream& printTo(TableData tabledata, std::ostream& out) const;
+        std::size_t value(TableData tabledata, const std::string& fieldname) const;
         std::optional<std::unique_ptr<Field>> operator[](const std::string& fieldname) const;
         void addSubfield(const std::string& fieldname, std::string subfieldname, unsigned startbit, unsigned endbit);
         void addSubfield(const std::string& fieldname, std::string subfieldname, unsigned startbit);
+        // the field of that name, or nullptr
+        Field* find(const std::string& fieldname) const;
+        Field* find(Symbol fieldname) const;
     private:
-        std::string name;
+        Symbol name;
         std::size_t totalsize = 0;
     };
 
-    /* an ARRAY is a numbered list of one type of field */
+    /* a RECORD is a field made of other fields, laid out by a shared Record */
+    class RECORD : public Field {
+    public:
+        const std::string& Name() const override { return name.str(); }
+        Symbol symbol() const override { return name; }
+        RECORD(std::string name, std::size_t offset, std::shared_ptr<const Record> layout);
+        std::ostream& printTo(TableData tabledata, std::ostream& out) const override;
+        // value of the named member
+        unsigned value(TableData tabledata, const std::string& membername) const override;
+        std::size_t size() const override { return layout->recordSize(); }
+        std::unique_ptr<Field> clone() const override {
+            return std::unique_ptr<Field>(new RECORD{ *this });
+        }
+        const Field* member(TableData& tabledata, const std::string& membername) const override;
+        const std::shared_ptr<const Record>& Layout() const { return layout; }
+    private:
+        Symbol name;
+        std::size_t offset;
+        std::shared_ptr<const Record> layout;
+    };
+
+    /* 
+     * an ARRAY is a numbered list of one type of field.  Elements are all
+     * the same size, so element N is found directly from the stride.
+     */
     class ARRAY : public Field {
     public:
-        std::string Name() const override { return name; }
+        const std::string& Name() const override { return name.str(); }
+        Symbol symbol() const override { return name; }
         ARRAY(std::string name, std::size_t offset, Record::fieldtype type, std::size_t fieldsize, std::size_t count);
-        std::ostream& printTo(const uint8_t* tabledata, std::ostream& out) const override;
+        ARRAY(std::string name, std::size_t offset, std::shared_ptr<const Record> layout, std::size_t count);
+        ARRAY(const ARRAY& other);
+        std::ostream& printTo(TableData tabledata, std::ostream& out) const override;
         // special indexed value version
-        unsigned value(const uint8_t *tabledata, std::size_t index) const override;
+        unsigned value(TableData tabledata, std::size_t index) const override;
+        // member of a record element
+        unsigned value(TableData tabledata, std::size_t index, const std::string& membername) const override;
         std::size_t size() const override { 
-            return rec->size() * count; 
+            return stride * count; 
         }
-        std::unique_ptr<Field> clone() const override;
+        std::unique_ptr<Field> clone() const override {
+            return std::unique_ptr<Field>(new ARRAY{ *this });
+        }
+        const Field* element(TableData& tabledata, std::size_t index) const override;
+        std::size_t Count() const { return count; }
+        // the field every element is, based at the start of the element
+        const Field& Element() const { return *rec; }
     private:
-        std::string name;
+        Symbol name;
         std::size_t offset;
         std::size_t count;
         std::unique_ptr<Field> rec;
+        std::size_t stride;
+    };
+
+    /*
+     * A non-owning view of one field of a table: the field definition
+     * and the table data it is applied to.  It is cheap to copy and
+     * decoding through it never allocates more than the result, but it
+     * is only valid as long as the table it came from.
+     */
+    class FieldRef {
+    public:
+        FieldRef(const Field& field, TableData tabledata) : fld{&field}, tabledata{tabledata} {}
+        const std::string& Name() const { return fld->Name(); }
+        std::size_t size() const { return fld->size(); }
+        unsigned value() const { return fld->value(tabledata); }
+        unsigned value(std::size_t index) const { return fld->value(tabledata, index); }
+        unsigned value(const std::string& subfieldname) const { return fld->value(tabledata, subfieldname); }
+        unsigned value(std::size_t index, const std::string& membername) const { return fld->value(tabledata, index, membername); }
+        std::string to_string() const { return fld->to_string(tabledata); }
+        Value typed() const { return fld->typed(tabledata); }
+        std::ostream& printTo(std::ostream& out) const { return fld->printTo(tabledata, out); }
+        const Field& field() const { return *fld; }
+        // element of an array or member of a record, if there is one
+        std::optional<FieldRef> element(std::size_t index) const;
+        std::optional<FieldRef> member(const std::string& membername) const;
+    private:
+        const Field* fld;
+        TableData tabledata;
     };
 
 
@@ -167,18 +333,33 @@ namespace C12 {
     public:
         Table(unsigned number, std::string name, std::string recordname, std::string data);
         Table(unsigned number, std::string name, std::string recordname, std::basic_string<uint8_t> data);
-        std::string Name() const override { return name; }
+        const std::string& Name() const override { return name.str(); }
+        Symbol symbol() const { return name; }
+        unsigned Number() const { return num; }
         std::size_t value(const std::string& fieldname) const;
         std::size_t value(const std::string& fieldname, std::size_t index) const;
         std::size_t value(const std::string& fieldname, const std::string& subfieldname) const;
+        std::size_t value(const std::string& fieldname, std::size_t index, const std::string& membername) const;
         std::string valueAsString(const std::string& fieldname) const;
+        // a view of the named field over this table's data, without copying either
+        std::optional<FieldRef> field(const std::string& fieldname) const;
+        std::optional<FieldRef> field(Symbol fieldname) const;
         std::ostream& printTo(std::ostream& out) const;
         std::size_t totalSize() const;
+        // bytes of table data, which may differ from totalSize() for a short read
+        std::size_t dataSize() const { return data.size(); }
+        // the table data as it was read
+        Bytes image() const { return Bytes{data.data(), data.size()}; }
+        // whether integers are big-endian, which GEN_CONFIG_TBL gives for the meter
+        bool bigEndian() const { return bigEndianData; }
+        void setDataOrder(bool bigEndian) { bigEndianData = bigEndian; }
     private:
+        TableData tabledata() const { return TableData{data.data(), bigEndianData}; }
         unsigned num = 0;
-        std::string name{};
+        Symbol name{};
         std::size_t totalsize = 0;
-        std::vector<uint8_t> data{};
+        std::pmr::vector<uint8_t> data{tableResource()};
+        bool bigEndianData = false;
     };
 }
 
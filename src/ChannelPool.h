@@ -0,0 +1,118 @@
+#ifndef CHANNELPOOL_H
+#define CHANNELPOOL_H
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace C12 {
+
+    /*
+     * Connected channels kept open between the meters of a fleet.  Many
+     * C12.22 meters sit behind one relay and differ only in their called
+     * AP title, so a channel to that relay can carry the associations of
+     * one meter after another without a TCP handshake for each.  Channels
+     * are kept under a key describing the peer, which for MChannel is its
+     * property string, and each carries one association at a time.
+     *
+     * A lease returns its channel to the pool when it goes out of scope,
+     * unless it was discarded, as after an error that may have left the
+     * connection in an unknown state.  At most maxIdle channels are kept
+     * for any one key; the others are closed by deleting them.
+     */
+    template <class Channel>
+    class ChannelPool {
+    public:
+        class Lease {
+        public:
+            Lease() = default;
+            Lease(Lease&& other) noexcept : pool{other.pool}, key{std::move(other.key)}, chan{std::move(other.chan)}, warm{other.warm} {}
+            Lease& operator=(Lease&& other) noexcept {
+                release();
+                pool = other.pool;
+                key = std::move(other.key);
+                chan = std::move(other.chan);
+                warm = other.warm;
+                return *this;
+            }
+            ~Lease() { release(); }
+            Channel* get() const { return chan.get(); }
+            Channel* operator->() const { return chan.get(); }
+            // true if the channel had carried an earlier association
+            bool reused() const { return warm; }
+            // closes the channel rather than returning it to the pool
+            void discard() { chan.reset(); }
+        private:
+            friend class ChannelPool;
+            Lease(ChannelPool* pool, std::string key, std::unique_ptr<Channel> chan, bool warm)
+                : pool{pool}, key{std::move(key)}, chan{std::move(chan)}, warm{warm} {}
+            void release() {
+                if (pool != nullptr && chan != nullptr)
+                    pool->release(key, std::move(chan));
+                chan.reset();
+            }
+            ChannelPool* pool = nullptr;
+            std::string key{};
+            std::unique_ptr<Channel> chan{};
+            bool warm = false;
+        };
+
+        explicit ChannelPool(std::size_t maxIdle = 4) : maxIdle{maxIdle} {}
+        ChannelPool(const ChannelPool&) = delete;
+        ChannelPool& operator=(const ChannelPool&) = delete;
+
+        // an idle channel kept under key, or else the one fresh() returns
+        template <class Make>
+        Lease acquire(const std::string& key, Make fresh) {
+            {
+                std::lock_guard<std::mutex> guard{lock};
+                auto it{idle.find(key)};
+                if (it != idle.end() && !it->second.empty()) {
+                    auto chan{std::move(it->second.back())};
+                    it->second.pop_back();
+                    ++reuses;
+                    return Lease{this, key, std::move(chan), true};
+                }
+            }
+            return create(key, fresh);
+        }
+        // the channel fresh() returns, passing over idle ones, as when a reused one has failed
+        template <class Make>
+        Lease create(const std::string& key, Make fresh) {
+            return Lease{this, key, fresh(), false};
+        }
+        // channels waiting to be reused
+        std::size_t size() const {
+            std::lock_guard<std::mutex> guard{lock};
+            std::size_t n{0};
+            for (const auto& entry : idle)
+                n += entry.second.size();
+            return n;
+        }
+        // how many leases got a channel that was already open
+        std::size_t reused() const {
+            std::lock_guard<std::mutex> guard{lock};
+            return reuses;
+        }
+        void clear() {
+            std::lock_guard<std::mutex> guard{lock};
+            idle.clear();
+        }
+    private:
+        void release(const std::string& key, std::unique_ptr<Channel> chan) {
+            std::lock_guard<std::mutex> guard{lock};
+            auto& kept{idle[key]};
+            if (kept.size() < maxIdle)
+                kept.push_back(std::move(chan));
+        }
+        std::size_t maxIdle;
+        mutable std::mutex lock{};
+        std::map<std::string, std::vector<std::unique_ptr<Channel>>> idle{};
+        std::size_t reuses = 0;
+    };
+}
+
+#endif // CHANNELPOOL_H
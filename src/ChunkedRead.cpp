@@ -0,0 +1,31 @@
+#include "ChunkedRead.h"
+#include <algorithm>
+
+namespace C12 {
+
+    /*
+     * Room kept in each C12.22 APDU for the ACSE header with both AP
+     * titles, the EPSEM envelope, a MAC when the session is secured, and
+     * the response code, count and checksum around the table data.
+     */
+    static constexpr unsigned apduOverhead{128};
+    // STP, reserved, control, sequence number and length, then the CRC
+    static constexpr unsigned packetOverhead{8};
+    // response code, count and checksum
+    static constexpr unsigned responseOverhead{4};
+
+    unsigned c1222ChunkSize(unsigned maxApduSizeIncoming) {
+        return std::max(maxApduSizeIncoming, 2 * apduOverhead) - apduOverhead;
+    }
+
+    unsigned c1218ChunkSize(unsigned packetSize, unsigned maxPackets) {
+        auto total{std::max(packetSize, packetOverhead + 1) - packetOverhead};
+        total *= std::max(maxPackets, 1u);
+        return std::max(total, responseOverhead + 1) - responseOverhead;
+    }
+
+    bool ChunkedRead::next(std::size_t bytes) {
+        received += bytes;
+        return bytes == chunk;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef CHUNKEDREAD_H
+#define CHUNKEDREAD_H
+#include <cstddef>
+
+namespace C12 {
+
+    // the table data that fits in one read response over C12.22
+    unsigned c1222ChunkSize(unsigned maxApduSizeIncoming);
+    // the same over C12.18, which splits a response over several packets
+    unsigned c1218ChunkSize(unsigned packetSize, unsigned maxPackets);
+
+    /*
+     * Plans the partial reads of a table of unknown size.  Each read asks
+     * for a whole chunk at the end of the data received so far, and the
+     * table ends with a short chunk.  A table that happens to be a whole
+     * number of chunks long ends instead with a read the meter refuses.
+     */
+    class ChunkedRead {
+    public:
+        static constexpr unsigned defaultChunkSize{1024};
+        explicit ChunkedRead(unsigned chunkSize = defaultChunkSize) : chunk{chunkSize ? chunkSize : 1} {}
+        // where the next read starts and how much it asks for
+        std::size_t offset() const { return received; }
+        unsigned size() const { return chunk; }
+        // accounts for the data of a read, false once the table is complete
+        bool next(std::size_t bytes);
+        // accounts for a refused read, false if that is an error rather than the end
+        bool refused() const { return received != 0; }
+    private:
+        unsigned chunk;
+        std::size_t received = 0;
+    };
+}
+
+#endif // CHUNKEDREAD_H
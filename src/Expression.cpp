@@ -0,0 +1,247 @@
+#include "Expression.h"
+#include <array>
+#include <cctype>
+#include <stdexcept>
+
+namespace C12 {
+
+    // the compiled program never needs more than this much stack
+    static constexpr std::size_t maxDepth{32};
+
+    /* recursive descent parser emitting code for each operator after its operands */
+    class Expression::Parser {
+    public:
+        Parser(const std::string& text, Expression& expr) : text{text}, expr{expr} {}
+
+        void parse() {
+            parseOr();
+            skipBlanks();
+            if (pos != text.size())
+                fail("unexpected '" + text.substr(pos, 1) + "'");
+            if (depth != 1)
+                fail("incomplete expression");
+        }
+
+    private:
+        [[noreturn]] void fail(const std::string& what) const {
+            throw std::invalid_argument(what + " at position " + std::to_string(pos) + " of \"" + text + "\"");
+        }
+
+        void skipBlanks() {
+            while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+                ++pos;
+        }
+
+        bool accept(const char* token) {
+            skipBlanks();
+            std::string tok{token};
+            if (text.compare(pos, tok.size(), tok) != 0)
+                return false;
+            // so that "<" does not take the first half of "<="
+            if (tok.size() == 1 && pos + 1 < text.size() && text[pos + 1] == '=' && std::string{"<>!="}.find(tok[0]) != std::string::npos)
+                return false;
+            pos += tok.size();
+            return true;
+        }
+
+        void emit(Op op, long arg = 0) {
+            expr.code.push_back(Instruction{op, arg});
+            if (op == Op::Const || op == Op::Ref) {
+                if (++depth > maxDepth)
+                    fail("expression too deep");
+            } else if (op != Op::Not && op != Op::Neg) {
+                --depth;
+            }
+        }
+
+        void parseOr() {
+            parseAnd();
+            while (accept("||")) {
+                parseAnd();
+                emit(Op::Or);
+            }
+        }
+
+        void parseAnd() {
+            parseComparison();
+            while (accept("&&")) {
+                parseComparison();
+                emit(Op::And);
+            }
+        }
+
+        void parseComparison() {
+            parseSum();
+            static const std::pair<const char*, Op> ops[]{
+                {"==", Op::Eq}, {"!=", Op::Ne}, {"<=", Op::Le}, {">=", Op::Ge}, {"<", Op::Lt}, {">", Op::Gt}
+            };
+            for (const auto& op : ops) {
+                if (accept(op.first)) {
+                    parseSum();
+                    emit(op.second);
+                    return;
+                }
+            }
+        }
+
+        void parseSum() {
+            parseProduct();
+            for (;;) {
+                if (accept("+")) {
+                    parseProduct();
+                    emit(Op::Add);
+                } else if (accept("-")) {
+                    parseProduct();
+                    emit(Op::Sub);
+                } else {
+                    return;
+                }
+            }
+        }
+
+        void parseProduct() {
+            parseUnary();
+            for (;;) {
+                if (accept("*")) {
+                    parseUnary();
+                    emit(Op::Mul);
+                } else if (accept("/")) {
+                    parseUnary();
+                    emit(Op::Div);
+                } else {
+                    return;
+                }
+            }
+        }
+
+        void parseUnary() {
+            if (accept("!")) {
+                parseUnary();
+                emit(Op::Not);
+            } else if (accept("-")) {
+                parseUnary();
+                emit(Op::Neg);
+            } else {
+                parsePrimary();
+            }
+        }
+
+        long parseNumber() {
+            std::size_t used{0};
+            try {
+                long value{std::stol(text.substr(pos), &used)};
+                pos += used;
+                return value;
+            }
+            catch (std::out_of_range&) {
+                fail("number out of range");
+            }
+        }
+
+        std::string parseName() {
+            auto start{pos};
+            while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_'))
+                ++pos;
+            if (pos == start)
+                fail("name expected");
+            return text.substr(start, pos - start);
+        }
+
+        void parsePrimary() {
+            skipBlanks();
+            if (pos >= text.size())
+                fail("operand expected");
+            if (accept("(")) {
+                parseOr();
+                if (!accept(")"))
+                    fail("')' expected");
+            } else if (std::isdigit(static_cast<unsigned char>(text[pos]))) {
+                emit(Op::Const, parseNumber());
+            } else {
+                Reference ref;
+                ref.table = Symbol{parseName()};
+                if (!accept("."))
+                    fail("'.' expected");
+                ref.field = Symbol{parseName()};
+                if (accept("."))
+                    ref.subfield = Symbol{parseName()};
+                if (accept("[")) {
+                    skipBlanks();
+                    if (pos >= text.size() || !std::isdigit(static_cast<unsigned char>(text[pos])))
+                        fail("index expected");
+                    ref.index = parseNumber();
+                    if (!accept("]"))
+                        fail("']' expected");
+                }
+                expr.refs.push_back(ref);
+                emit(Op::Ref, static_cast<long>(expr.refs.size() - 1));
+            }
+        }
+
+        const std::string& text;
+        Expression& expr;
+        std::size_t pos = 0;
+        std::size_t depth = 0;
+    };
+
+    Expression::Expression(const std::string& source)
+        : text{source}
+    {
+        Parser{text, *this}.parse();
+    }
+
+    std::optional<long> Expression::evaluate(const Resolver& resolve) const {
+        std::array<long, maxDepth> stack;
+        std::size_t top{0};
+        for (const auto& ins : code) {
+            switch (ins.op) {
+            case Op::Const:
+                stack[top++] = ins.arg;
+                continue;
+            case Op::Ref:
+                if (auto value = resolve(refs[ins.arg])) {
+                    stack[top++] = *value;
+                    continue;
+                }
+                return std::nullopt;
+            case Op::Not:
+                stack[top - 1] = !stack[top - 1];
+                continue;
+            case Op::Neg:
+                stack[top - 1] = -stack[top - 1];
+                continue;
+            default:
+                break;
+            }
+            auto rhs{stack[--top]};
+            auto& lhs{stack[top - 1]};
+            switch (ins.op) {
+            case Op::Mul: lhs = lhs * rhs; break;
+            case Op::Div: lhs = rhs ? lhs / rhs : 0; break;
+            case Op::Add: lhs = lhs + rhs; break;
+            case Op::Sub: lhs = lhs - rhs; break;
+            case Op::Lt: lhs = lhs < rhs; break;
+            case Op::Le: lhs = lhs <= rhs; break;
+            case Op::Gt: lhs = lhs > rhs; break;
+            case Op::Ge: lhs = lhs >= rhs; break;
+            case Op::Eq: lhs = lhs == rhs; break;
+            case Op::Ne: lhs = lhs != rhs; break;
+            case Op::And: lhs = lhs && rhs; break;
+            case Op::Or: lhs = lhs || rhs; break;
+            default: break;
+            }
+        }
+        return stack[0];
+    }
+
+    long resolve(const Table& tbl, const Reference& ref) {
+        auto fld{tbl.field(ref.field)};
+        if (!fld)
+            return 0;
+        if (ref.subfield)
+            return fld->value(ref.subfield.str());
+        if (ref.index)
+            return fld->value(*ref.index);
+        return fld->value();
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include "C12Tables.h"
+#include "Symbol.h"
+
+namespace C12 {
+
+    /* a value in another table: TABLE.FIELD, TABLE.FIELD.SUBFIELD or TABLE.FIELD[INDEX] */
+    struct Reference {
+        Symbol table{};
+        Symbol field{};
+        Symbol subfield{};
+        std::optional<std::size_t> index{};
+    };
+
+    /*
+     * A condition or dimension of a table layout, such as
+     *
+     *     GEN_CONFIG_TBL.FORMAT_CONTROL_2.TM_FORMAT == 2
+     *     !ACT_TIME_TOU_TBL.TIME_FUNC_FLAG2_BFLD.SEPARATE_SUM_DEMANDS_FLAG
+     *     GEN_CONFIG_TBL.STD_TBLS_USED[64]
+     *     ACT_REGS_TBL.NBR_SUMMATIONS * 2
+     *
+     * The text is compiled once into a small stack machine program with
+     * its references already interned, so evaluating it while building a
+     * table does no parsing or string comparison.  It supports integers,
+     * references, parentheses, ! and unary -, * / + -, comparisons, &&
+     * and ||, with the usual C precedence.
+     */
+    class Expression {
+    public:
+        // looks up a reference, or returns nothing if its table was not read
+        using Resolver = std::function<std::optional<long>(const Reference&)>;
+        // throws std::invalid_argument on a syntax error
+        explicit Expression(const std::string& source);
+        // the value, or nothing if any table it refers to is missing
+        std::optional<long> evaluate(const Resolver& resolve) const;
+        const std::string& source() const { return text; }
+        const std::vector<Reference>& references() const { return refs; }
+    private:
+        enum class Op : uint8_t { Const, Ref, Not, Neg, Mul, Div, Add, Sub, Lt, Le, Gt, Ge, Eq, Ne, And, Or };
+        struct Instruction {
+            Op op;
+            long arg;
+        };
+        class Parser;
+        std::string text;
+        std::vector<Instruction> code{};
+        std::vector<Reference> refs{};
+    };
+
+    // the value a reference names in tbl, which is 0 if tbl has no such field
+    long resolve(const Table& tbl, const Reference& ref);
+}
+
+#endif // EXPRESSION_H
@@ -0,0 +1,96 @@
+#include "Fleet.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace C12 {
+
+    static std::string trim(const std::string& str) {
+        static const char* blanks{" \t\r\n"};
+        auto first{str.find_first_not_of(blanks)};
+        if (first == std::string::npos)
+            return "";
+        return str.substr(first, str.find_last_not_of(blanks) + 1 - first);
+    }
+
+    Fleet readFleet(std::istream& in) {
+        enum class Section { None, Protocol, Channel, Meter } section{Section::None};
+        Fleet fleet;
+        std::string line;
+        for (unsigned lineNumber{1}; std::getline(in, line); ++lineNumber) {
+            const auto error = [lineNumber](const std::string& what) {
+                return std::runtime_error("line " + std::to_string(lineNumber) + ": " + what);
+            };
+            line = trim(line);
+            if (line.empty() || line[0] == ';' || line[0] == '#')
+                continue;
+            if (line[0] == '[') {
+                if (line == "[protocol]") {
+                    section = Section::Protocol;
+                } else if (line == "[channel]") {
+                    section = Section::Channel;
+                } else if (line == "[meter]") {
+                    section = Section::Meter;
+                    fleet.meters.emplace_back();
+                } else {
+                    throw error("sections expected are only [protocol], [channel] or [meter]");
+                }
+                continue;
+            }
+            auto eq{line.find('=')};
+            if (eq == std::string::npos)
+                throw error("NAME=VALUE expected");
+            auto name{trim(line.substr(0, eq))};
+            auto value{trim(line.substr(eq + 1))};
+            switch (section) {
+            case Section::None:
+                throw error("value outside of a section");
+            case Section::Protocol:
+                fleet.protocol.emplace_back(name, value);
+                break;
+            case Section::Channel:
+                fleet.channel.emplace_back(name, value);
+                break;
+            case Section::Meter:
+                if (name == "NAME") {
+                    fleet.meters.back().name = value;
+                } else if (name == "TABLES") {
+                    std::istringstream ss{value};
+                    for (std::string tbl; ss >> tbl; )
+                        fleet.meters.back().tables.push_back(tbl);
+                } else {
+                    fleet.meters.back().properties.emplace_back(name, value);
+                }
+                break;
+            }
+        }
+        // unnamed meters are numbered in the order they appear
+        for (std::size_t i{0}; i < fleet.meters.size(); ++i) {
+            if (fleet.meters[i].name.empty())
+                fleet.meters[i].name = "meter" + std::to_string(i + 1);
+        }
+        return fleet;
+    }
+
+    Fleet readFleet(const std::string& fileName) {
+        std::ifstream in{fileName};
+        if (!in)
+            throw std::runtime_error("cannot open " + fileName);
+        try {
+            return readFleet(in);
+        }
+        catch (std::runtime_error& ex) {
+            throw std::runtime_error(fileName + ", " + ex.what());
+        }
+    }
+
+    std::string propertyString(const Properties& properties) {
+        std::string str;
+        for (const auto& prop : properties) {
+            if (!str.empty())
+                str += ';';
+            str += prop.first + '=' + prop.second;
+        }
+        return str;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef FLEET_H
+#define FLEET_H
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace C12 {
+
+    using Properties = std::vector<std::pair<std::string, std::string>>;
+
+    /* one meter of a fleet: its name, what to read and its own properties */
+    struct FleetMeter {
+        std::string name{};
+        std::vector<std::string> tables{};
+        Properties properties{};
+    };
+
+    /*
+     * A fleet file lists many meters to be read by one process.  Its
+     * [protocol] and [channel] sections hold the defaults shared by every
+     * meter, as in the ordinary configuration file, and each [meter]
+     * section describes one meter:
+     *
+     *     [meter]
+     *     NAME=north-1
+     *     TABLES=ST1 ST5 ST23
+     *     PEER_ADDRESS=10.0.0.1
+     *     CALLED_AP_TITLE=...
+     *
+     * Any other name in a [meter] section overrides the channel or
+     * protocol property of that name for this meter only.
+     */
+    struct Fleet {
+        Properties protocol{};
+        Properties channel{};
+        std::vector<FleetMeter> meters{};
+    };
+
+    // throws std::runtime_error naming the line of a malformed file
+    Fleet readFleet(std::istream& in);
+    Fleet readFleet(const std::string& fileName);
+
+    // properties joined as NAME=VALUE;NAME=VALUE for the MCOM factory
+    std::string propertyString(const Properties& properties);
+}
+
+#endif // FLEET_H
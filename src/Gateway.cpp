@@ -0,0 +1,169 @@
+#include "Gateway.h"
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace C12 {
+
+    static void throwErrno(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    // how often waiting threads look at the stop flag
+    static constexpr int pollMilliseconds{200};
+
+    Gateway::Gateway(Read read, Query query) : read{std::move(read)}, query{std::move(query)} {}
+
+    Gateway::~Gateway() {
+        stop();
+        for (auto& connection : connections)
+            connection.thread.join();
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            ::unlink(path.c_str());
+        }
+    }
+
+    void Gateway::listen(const std::string& socketPath) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof address.sun_path)
+            throw std::runtime_error("socket path is too long: " + socketPath);
+        std::strcpy(address.sun_path, socketPath.c_str());
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0)
+            throwErrno("cannot create socket");
+        ::unlink(socketPath.c_str());
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof address) != 0)
+            throwErrno("cannot bind " + socketPath);
+        path = socketPath;
+        // before listening, so that no one else ever connects
+        if (::chmod(socketPath.c_str(), S_IRUSR | S_IWUSR) != 0)
+            throwErrno("cannot restrict access to " + socketPath);
+        if (::listen(listenFd, 16) != 0)
+            throwErrno("cannot listen on " + socketPath);
+    }
+
+    void Gateway::serve(const std::function<bool()>& interrupted) {
+        while (!stopping && !(interrupted && interrupted())) {
+            reap();
+            pollfd p{listenFd, POLLIN, 0};
+            if (::poll(&p, 1, pollMilliseconds) <= 0)
+                continue;
+            int fd{::accept(listenFd, nullptr, nullptr)};
+            if (fd < 0)
+                continue;
+            if (live >= maxConnections) {
+                static const std::string busy{"ERROR too many connections\n"};
+                ::send(fd, busy.data(), busy.size(), MSG_NOSIGNAL);
+                ::close(fd);
+                continue;
+            }
+            std::lock_guard<std::mutex> guard{connectionsLock};
+            auto& connection{connections.emplace_back()};
+            ++live;
+            connection.thread = std::thread{[this, fd, &connection]{
+                converse(fd);
+                connection.done = true;
+                --live;
+            }};
+        }
+        stopping = true;
+        std::lock_guard<std::mutex> guard{connectionsLock};
+        for (auto& connection : connections)
+            connection.thread.join();
+        connections.clear();
+    }
+
+    void Gateway::reap() {
+        std::lock_guard<std::mutex> guard{connectionsLock};
+        for (auto it{connections.begin()}; it != connections.end(); ) {
+            if (it->done) {
+                it->thread.join();
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void Gateway::converse(int fd) {
+        std::string pending;
+        char buffer[512];
+        while (!stopping) {
+            pollfd p{fd, POLLIN, 0};
+            if (::poll(&p, 1, pollMilliseconds) <= 0)
+                continue;
+            auto n{::read(fd, buffer, sizeof buffer)};
+            if (n <= 0)
+                break;
+            pending.append(buffer, static_cast<std::size_t>(n));
+            for (auto end{pending.find('\n')}; end != std::string::npos; end = pending.find('\n')) {
+                auto answer{handle(pending.substr(0, end)) + '\n'};
+                pending.erase(0, end + 1);
+                if (::send(fd, answer.data(), answer.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(answer.size())) {
+                    ::close(fd);
+                    return;
+                }
+            }
+        }
+        ::close(fd);
+    }
+
+    void Gateway::fresh(const std::string& item, std::chrono::seconds maxAge) {
+        {
+            std::lock_guard<std::mutex> guard{readTimesLock};
+            auto it{readTimes.find(item)};
+            if (it != readTimes.end() && clock::now() - it->second <= maxAge)
+                return;
+        }
+        flights.run(item, [&]{
+            std::lock_guard<std::mutex> meter{meterLock};
+            auto started{clock::now()};
+            read(item);
+            ++readCount;
+            // recorded before the flight ends, so that a later query finds it fresh
+            std::lock_guard<std::mutex> guard{readTimesLock};
+            readTimes[item] = started;
+        });
+    }
+
+    std::string Gateway::handle(const std::string& request) {
+        std::istringstream ss{request};
+        std::string item;
+        long maxAge{-1};
+        std::string expression;
+        ss >> item >> maxAge;
+        std::getline(ss >> std::ws, expression);
+        if (!expression.empty() && expression.back() == '\r')
+            expression.pop_back();
+        if (item.empty() || maxAge < 0 || expression.empty())
+            return "ERROR expected: <item> <max-age-seconds> <expression>";
+        try {
+            fresh(item, std::chrono::seconds(maxAge));
+            return query(expression);
+        }
+        catch (std::exception& ex) {
+            return std::string{"ERROR "} + ex.what();
+        }
+    }
+
+    Gateway::Query snapshotQuery(std::function<std::shared_ptr<const TableSnapshot>()> latest) {
+        return [latest = std::move(latest)](const std::string& expression) {
+            auto value{latest()->evaluateAsString(expression)};
+            if (value.empty())
+                throw std::runtime_error("no value for " + expression);
+            // an answer is one line
+            if (value.find('\n') != std::string::npos)
+                throw std::runtime_error(expression + " is not a single value");
+            return value;
+        };
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef GATEWAY_H
+#define GATEWAY_H
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "SingleFlight.h"
+#include "TableSnapshot.h"
+
+namespace C12 {
+
+    /*
+     * Answers queries about one meter from other processes on the same
+     * host, over a Unix domain socket, so that they share one meter
+     * session rather than each starting its own.  A query is one line:
+     *
+     *     <item> <max-age-seconds> <expression>
+     *
+     * such as "ST23 60 CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK.SUMMATIONS[0]".
+     * The item is read from the meter unless it was read less than
+     * max-age seconds ago, and then the expression is evaluated over the
+     * tables read so far, as TableSnapshot::evaluateAsString does.  The answer is one line with the value, or
+     * "ERROR" and a message.  Queries for an item that is being read
+     * wait for that read rather than starting another, and the meter is
+     * only ever used by one read at a time.  Evaluations do not wait for
+     * it, so a query for a fresh item is answered while another is read.
+     *
+     * The socket is only open to the user running the gateway, and each
+     * connection is served by a thread of its own, up to maxConnections
+     * at a time; any more are answered with an error and closed.
+     */
+    class Gateway {
+    public:
+        using clock = std::chrono::steady_clock;
+        // reads an item from the meter, throwing if it cannot
+        using Read = std::function<void(const std::string& item)>;
+        // the value of an expression over the tables read so far, called
+        // while another item may be read, so it should use a snapshot
+        using Query = std::function<std::string(const std::string& expression)>;
+        static constexpr std::size_t maxConnections{32};
+        Gateway(Read read, Query query);
+        ~Gateway();
+        Gateway(const Gateway&) = delete;
+        Gateway& operator=(const Gateway&) = delete;
+        // creates the socket, replacing any left by an earlier run
+        void listen(const std::string& socketPath);
+        // accepts connections until stop() or until interrupted returns true
+        void serve(const std::function<bool()>& interrupted = {});
+        void stop() { stopping = true; }
+        // the answer to one query line, without the end of line
+        std::string handle(const std::string& request);
+        // reads of the meter made for queries
+        std::size_t reads() const { return readCount; }
+        // queries that waited for a read started by another
+        std::size_t shared() const { return flights.shared(); }
+        // connections being served now
+        std::size_t connected() const { return live; }
+    private:
+        struct Connection {
+            std::thread thread{};
+            std::atomic<bool> done{false};
+        };
+        void fresh(const std::string& item, std::chrono::seconds maxAge);
+        void converse(int fd);
+        // joins the threads of connections that have ended
+        void reap();
+        Read read;
+        Query query;
+        std::mutex meterLock{};
+        std::mutex readTimesLock{};
+        std::map<std::string, clock::time_point> readTimes{};
+        SingleFlight<std::string> flights{};
+        std::atomic<std::size_t> readCount{0};
+        std::atomic<bool> stopping{false};
+        std::string path{};
+        int listenFd = -1;
+        std::mutex connectionsLock{};
+        std::list<Connection> connections{};
+        std::atomic<std::size_t> live{0};
+    };
+
+    // the query of a gateway over whichever snapshot latest returns, refusing
+    // a field with no value of one line, such as a whole record
+    Gateway::Query snapshotQuery(std::function<std::shared_ptr<const TableSnapshot>()> latest);
+}
+
+#endif // GATEWAY_H
@@ -0,0 +1,360 @@
+#include "LinkEmulator.h"
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <system_error>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace C12 {
+
+    static constexpr uint8_t STP{0xEE};
+    static constexpr uint8_t ACK{0x06};
+    static constexpr uint8_t NAK{0x15};
+    static constexpr std::size_t packetOverhead{8};
+
+    // response codes
+    static constexpr char OK{0x00};
+    static constexpr char SNS{0x02};
+    static constexpr char ONP{0x04};
+
+    std::chrono::microseconds LinkModel::byteTime() const {
+        // one start bit, eight data bits and one stop bit
+        return std::chrono::microseconds{baud ? 10'000'000 / baud : 0} + byteDelay;
+    }
+
+    std::chrono::microseconds LinkModel::transferTime(std::size_t bytes) const {
+        return turnAround + byteTime() * bytes;
+    }
+
+    static void throwErrno(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    static void setRaw(int fd) {
+        termios tio{};
+        if (tcgetattr(fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+
+    static void writeAll(int fd, const char* buf, std::size_t len) {
+        while (len) {
+            auto n{::write(fd, buf, len)};
+            if (n < 0) {
+                if (errno == EINTR || errno == EAGAIN)
+                    continue;
+                return;
+            }
+            buf += n;
+            len -= n;
+        }
+    }
+
+    /*
+     * Opens a pseudo terminal pair and returns the master.  The slave is
+     * kept open as well so that the master does not see a hangup each
+     * time the channel closes and reopens the port.
+     */
+    static int openPty(std::string& name, int& slave) {
+        int master{posix_openpt(O_RDWR | O_NOCTTY)};
+        if (master < 0 || grantpt(master) || unlockpt(master))
+            throwErrno("cannot create pseudo terminal");
+        char buf[128];
+        if (ptsname_r(master, buf, sizeof buf))
+            throwErrno("cannot name pseudo terminal");
+        name = buf;
+        slave = ::open(buf, O_RDWR | O_NOCTTY);
+        if (slave < 0)
+            throwErrno("cannot open " + name);
+        setRaw(slave);
+        setRaw(master);
+        return master;
+    }
+
+    C1218Responder::C1218Responder(int fd, TableImages tables)
+        : fd{ fd }
+        , tables{ std::move(tables) }
+    {
+    }
+
+    int C1218Responder::readByte(int timeout_ms) {
+        pollfd p{fd, POLLIN, 0};
+        if (poll(&p, 1, timeout_ms) <= 0)
+            return -1;
+        uint8_t ch;
+        return ::read(fd, &ch, 1) == 1 ? ch : -1;
+    }
+
+    void C1218Responder::run(const std::atomic<bool>& stop) {
+        std::string lastRequest;
+        std::string lastResponse;
+        while (!stop) {
+            int ch{readByte(100)};
+            if (ch != STP)
+                continue;   // ACK, NAK or line noise between packets
+            std::string pkt(1, static_cast<char>(STP));
+            bool complete{true};
+            for (std::size_t i{0}; complete && i < 5; ++i) {
+                ch = readByte(500);
+                complete = ch >= 0;
+                pkt.push_back(static_cast<char>(ch));
+            }
+            std::size_t len{complete ? (uint8_t(pkt[4]) << 8u) | uint8_t(pkt[5]) : 0u};
+            for (std::size_t i{0}; complete && i < len + 2; ++i) {
+                ch = readByte(500);
+                complete = ch >= 0;
+                pkt.push_back(static_cast<char>(ch));
+            }
+            auto crc{crc16(reinterpret_cast<const uint8_t*>(pkt.data()), pkt.size() - 2)};
+            if (!complete || uint8_t(pkt[pkt.size() - 2]) != (crc & 0xFF) || uint8_t(pkt[pkt.size() - 1]) != (crc >> 8)) {
+                char nak = static_cast<char>(NAK);
+                writeAll(fd, &nak, 1);
+                continue;
+            }
+            char ack = static_cast<char>(ACK);
+            writeAll(fd, &ack, 1);
+            auto request{pkt.substr(6, len)};
+            // a repeated request means our response was lost, so repeat it
+            if (request != lastRequest || (!request.empty() && uint8_t(request[0]) == 0x20)) {
+                lastRequest = request;
+                lastResponse = respond(request);
+            }
+            send(lastResponse, stop);
+        }
+    }
+
+    bool C1218Responder::send(const std::string& response, const std::atomic<bool>& stop) {
+        const std::size_t chunk{packetSize > packetOverhead ? packetSize - packetOverhead : 1};
+        const std::size_t packets{response.empty() ? 1 : (response.size() + chunk - 1) / chunk};
+        for (std::size_t i{0}; i < packets; ++i) {
+            uint8_t ctrl{static_cast<uint8_t>(toggle ? 0x20 : 0)};
+            if (packets > 1) {
+                ctrl |= 0x80;
+                if (i == 0)
+                    ctrl |= 0x40;
+            }
+            toggle = !toggle;
+            auto pkt{makePacket(ctrl, static_cast<uint8_t>(packets - 1 - i), response.substr(i * chunk, chunk))};
+            bool acked{false};
+            for (int attempt{0}; !acked && attempt < 3 && !stop; ++attempt) {
+                writeAll(fd, pkt.data(), pkt.size());
+                // wait up to two seconds for the ACK, staying responsive to stop
+                for (int slice{0}; slice < 20 && !stop; ) {
+                    int ch{readByte(100)};
+                    if (ch < 0) {
+                        ++slice;
+                        continue;
+                    }
+                    if (ch == ACK)
+                        acked = true;
+                    if (ch == ACK || ch == NAK)
+                        break;
+                }
+            }
+            if (!acked)
+                return false;
+        }
+        return true;
+    }
+
+    std::string C1218Responder::respond(const std::string& request) {
+        const auto byte = [&request](std::size_t i) -> unsigned {
+            return i < request.size() ? uint8_t(request[i]) : 0u;
+        };
+        const unsigned code{byte(0)};
+        if (code == 0x20) {             // identify: C12.18 version 1.0, no features
+            return std::string{OK, 0x00, 0x01, 0x00, 0x00};
+        }
+        if (code >= 0x60 && code <= 0x6B) {     // negotiate
+            packetSize = std::max<std::size_t>(packetOverhead + 1, (byte(1) << 8) | byte(2));
+            std::string resp{OK};
+            resp.append(request, 1, 3);
+            resp.push_back(static_cast<char>(code > 0x60 ? byte(4) : 0));
+            return resp;
+        }
+        if (code == 0x30 || code == 0x3F) {     // full or offset partial read
+            auto tbl{tables.find((byte(1) << 8) | byte(2))};
+            if (tbl == tables.end())
+                return std::string{ONP};
+            std::string data{tbl->second};
+            if (code == 0x3F) {
+                std::size_t offset{(byte(3) << 16) | (byte(4) << 8) | byte(5)};
+                std::size_t count{(byte(6) << 8) | byte(7)};
+                if (offset > data.size())
+                    return std::string{ONP};
+                data = data.substr(offset, count);
+            }
+            uint8_t sum{0};
+            for (auto ch : data)
+                sum += static_cast<uint8_t>(ch);
+            std::string resp{OK, static_cast<char>(data.size() >> 8), static_cast<char>(data.size())};
+            resp += data;
+            resp.push_back(static_cast<char>(-sum));
+            return resp;
+        }
+        switch (code) {
+        case 0x21:  // terminate
+        case 0x50:  // logon
+        case 0x51:  // security
+        case 0x52:  // logoff
+        case 0x70:  // wait
+        case 0x40:  // full write
+        case 0x4F:  // partial write
+            return std::string{OK};
+        }
+        return std::string{SNS};
+    }
+
+    C1218Responder::TableImages C1218Responder::defaultTables() {
+        using namespace std::string_literals;
+        TableImages images;
+        images[0] =
+            "\x02\x02\x88" "EPRI" "\x02\x00\x20\xFF\x02\x00"
+            "\x08\x00\x01\x00\x00\x00"
+            "\x2B\x00\x00\x00\x00\x00\x10\x00"  // ST0 ST1 ST3 ST5 ST52
+            "\x00"
+            "\x00\x00\x00\x00\x00\x00\x00\x00"s;
+        images[1] = "EPRI" "SIMULATR" "\x01\x00\x01\x00" "0000000000000001"s;
+        images[3] = "\x01\x00\x00\x00\x00"s;
+        images[5] = "SIMULATED-METER-0001"s;
+        images[52] = "\x15\x08\x19\x0C\x00\x00\x03"s;
+        return images;
+    }
+
+    C1218Responder::TableImages C1218Responder::loadTables(const std::string& directory) {
+        TableImages images;
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            auto stem{entry.path().stem().string()};
+            if (entry.path().extension() != ".bin" || stem.size() < 3 || stem[1] != 'T')
+                continue;
+            if (stem[0] != 'S' && stem[0] != 'M')
+                continue;
+            unsigned number = std::stoul(stem.substr(2)) + (stem[0] == 'M' ? 2048 : 0);
+            std::ifstream in{entry.path(), std::ios::binary};
+            images[number].assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+        }
+        return images;
+    }
+
+    LinkEmulator::LinkEmulator(LinkModel model)
+        : model{ model }
+    {
+    }
+
+    LinkEmulator::~LinkEmulator() {
+        close();
+    }
+
+    void LinkEmulator::open(const std::string& peer, const std::string& tableDirectory) {
+        close();
+        stop = false;
+        nearFd = openPty(port, nearSlaveFd);
+        if (peer.empty() || peer == "LOOPBACK") {
+            int sv[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv))
+                throwErrno("cannot create loopback");
+            farFd = sv[0];
+            responderFd = sv[1];
+            auto images{tableDirectory.empty() ? C1218Responder::defaultTables() : C1218Responder::loadTables(tableDirectory)};
+            responder = std::thread([this, images]{
+                C1218Responder meter{responderFd, images};
+                meter.run(stop);
+            });
+        } else if (peer == "PTY") {
+            farFd = openPty(peerPort, farSlaveFd);
+        } else {
+            farFd = ::open(peer.c_str(), O_RDWR | O_NOCTTY);
+            if (farFd < 0)
+                throwErrno("cannot open " + peer);
+            setRaw(farFd);
+        }
+        shaper = std::thread(&LinkEmulator::shape, this);
+    }
+
+    void LinkEmulator::close() {
+        stop = true;
+        if (shaper.joinable())
+            shaper.join();
+        if (responder.joinable())
+            responder.join();
+        for (int* fd : { &nearFd, &nearSlaveFd, &farFd, &farSlaveFd, &responderFd }) {
+            if (*fd >= 0)
+                ::close(*fd);
+            *fd = -1;
+        }
+    }
+
+    LinkStatistics LinkEmulator::statistics() const {
+        return LinkStatistics{ toPeer, fromPeer, corrupted, dropped };
+    }
+
+    void LinkEmulator::shape() {
+        using clock = std::chrono::steady_clock;
+        struct Pending {
+            char byte;
+            clock::time_point due;
+        };
+        std::deque<Pending> queue[2];       // [0] toward the peer, [1] toward the channel
+        const int from[2]{ nearFd, farFd };
+        const int to[2]{ farFd, nearFd };
+        std::mt19937 rng(model.seed);
+        std::uniform_real_distribution<double> uniform{0.0, 1.0};
+        auto lineFree{clock::now()};
+        int lastDirection{-1};
+        char buf[256];
+        while (!stop) {
+            auto now{clock::now()};
+            for (int dir{0}; dir < 2; ++dir) {
+                std::string out;
+                while (!queue[dir].empty() && queue[dir].front().due <= now) {
+                    out.push_back(queue[dir].front().byte);
+                    queue[dir].pop_front();
+                }
+                writeAll(to[dir], out.data(), out.size());
+                (dir ? fromPeer : toPeer) += out.size();
+            }
+            auto wait{std::chrono::microseconds{50'000}};
+            for (const auto& q : queue) {
+                if (!q.empty())
+                    wait = std::min(wait, std::chrono::duration_cast<std::chrono::microseconds>(q.front().due - now));
+            }
+            timespec ts{0, static_cast<long>(std::max(wait.count(), 0L) * 1000)};
+            pollfd p[2]{ { nearFd, POLLIN, 0 }, { farFd, POLLIN, 0 } };
+            if (ppoll(p, 2, &ts, nullptr) <= 0)
+                continue;
+            for (int dir{0}; dir < 2; ++dir) {
+                if (!(p[dir].revents & POLLIN))
+                    continue;
+                auto n{::read(from[dir], buf, sizeof buf)};
+                for (ssize_t i{0}; i < n; ++i) {
+                    if (model.dropRate > 0 && uniform(rng) < model.dropRate) {
+                        ++dropped;
+                        continue;
+                    }
+                    char byte{buf[i]};
+                    if (model.bitErrorRate > 0) {
+                        for (int bit{0}; bit < 8; ++bit) {
+                            if (uniform(rng) < model.bitErrorRate) {
+                                byte ^= static_cast<char>(1 << bit);
+                                ++corrupted;
+                            }
+                        }
+                    }
+                    auto start{std::max(clock::now(), lineFree)};
+                    if (dir != lastDirection)
+                        start += model.turnAround;
+                    lastDirection = dir;
+                    lineFree = start + model.byteTime();
+                    queue[dir].push_back(Pending{byte, lineFree});
+                }
+            }
+        }
+    }
+}
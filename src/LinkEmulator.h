@@ -0,0 +1,103 @@
+#ifndef LINKEMULATOR_H
+#define LINKEMULATOR_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include "C1218Packet.h"
+
+namespace C12 {
+
+    /*
+     * Timing and error model for an emulated half-duplex serial link
+     * such as the C12.18 optical port.  Every byte is delayed by its
+     * serialization time at the configured baud rate (10 bits per byte)
+     * plus a fixed per-byte delay, and each change of direction on the
+     * line costs an additional turnaround time.  Errors are drawn from a
+     * seeded generator so a given configuration is repeatable.
+     */
+    struct LinkModel {
+        unsigned baud = 9600;
+        std::chrono::microseconds byteDelay{0};
+        std::chrono::microseconds turnAround{0};
+        double bitErrorRate = 0.0;
+        double dropRate = 0.0;
+        unsigned long seed = 1;
+
+        std::chrono::microseconds byteTime() const;
+        std::chrono::microseconds transferTime(std::size_t bytes) const;
+    };
+
+    struct LinkStatistics {
+        std::size_t bytesToPeer = 0;
+        std::size_t bytesFromPeer = 0;
+        std::size_t bitsCorrupted = 0;
+        std::size_t bytesDropped = 0;
+    };
+
+    /*
+     * A minimal C12.18 responder which answers identify, negotiate,
+     * logon, security, logoff, terminate, wait and table read requests
+     * from a set of table images.  It is meant as a stand-in for a meter
+     * at the far end of a LinkEmulator, not as a conforming device.
+     */
+    class C1218Responder {
+    public:
+        using TableImages = std::map<unsigned, std::string>;
+        C1218Responder(int fd, TableImages tables);
+        void run(const std::atomic<bool>& stop);
+        static TableImages defaultTables();
+        static TableImages loadTables(const std::string& directory);
+    private:
+        std::string respond(const std::string& request);
+        bool send(const std::string& packet, const std::atomic<bool>& stop);
+        int readByte(int timeout_ms);
+        int fd;
+        TableImages tables;
+        std::size_t packetSize = 64;
+        bool toggle = false;
+    };
+
+    /*
+     * Emulated link between a pseudo terminal, which any serial channel
+     * can open by name, and a peer.  The peer is either the built-in
+     * C1218Responder ("LOOPBACK"), a second pseudo terminal for an
+     * external process ("PTY") or a device path.
+     */
+    class LinkEmulator {
+    public:
+        explicit LinkEmulator(LinkModel model);
+        ~LinkEmulator();
+        LinkEmulator(const LinkEmulator&) = delete;
+        LinkEmulator& operator=(const LinkEmulator&) = delete;
+        void open(const std::string& peer, const std::string& tableDirectory = "");
+        void close();
+        // name of the pseudo terminal the channel should use as PORT_NAME
+        std::string portName() const { return port; }
+        // name of the far pseudo terminal when the peer is "PTY"
+        std::string peerName() const { return peerPort; }
+        LinkStatistics statistics() const;
+    private:
+        void shape();
+        LinkModel model;
+        std::string port{};
+        std::string peerPort{};
+        int nearFd = -1;
+        int nearSlaveFd = -1;
+        int farFd = -1;
+        int farSlaveFd = -1;
+        int responderFd = -1;
+        std::atomic<bool> stop{false};
+        std::thread shaper{};
+        std::thread responder{};
+        std::atomic<std::size_t> toPeer{0};
+        std::atomic<std::size_t> fromPeer{0};
+        std::atomic<std::size_t> corrupted{0};
+        std::atomic<std::size_t> dropped{0};
+    };
+}
+
+#endif // LINKEMULATOR_H
@@ -0,0 +1,102 @@
+#include "MonitorLog.h"
+#include "C1218Packet.h"
+#include "AsyncLog.h"
+#include <cctype>
+#include <optional>
+#include <sstream>
+
+namespace C12 {
+
+    static bool isHexByte(const std::string& token) {
+        return token.size() == 2 && std::isxdigit(static_cast<unsigned char>(token[0]))
+            && std::isxdigit(static_cast<unsigned char>(token[1]));
+    }
+
+    /*
+     * Returns 0 for a line of transmitted bytes, 1 for received bytes
+     * and -1 otherwise, leaving the bytes in the passed string.
+     */
+    static int parseLogLine(const std::string& line, std::string& bytes) {
+        std::istringstream ss{line};
+        std::string token;
+        int direction{-1};
+        bytes.clear();
+        while (ss >> token) {
+            if (direction < 0) {
+                if (token.size() >= 2 && (token[1] == 'x' || token[1] == 'X')) {
+                    if (token[0] == 'T' || token[0] == 't')
+                        direction = 0;
+                    else if (token[0] == 'R' || token[0] == 'r')
+                        direction = 1;
+                }
+            } else if (isHexByte(token)) {
+                bytes.push_back(static_cast<char>(std::stoul(token, nullptr, 16)));
+            } else if (!bytes.empty()) {
+                break;
+            }
+        }
+        return bytes.empty() ? -1 : direction;
+    }
+
+    std::vector<TableImage> extractTableImages(std::istream& log) {
+        std::vector<TableImage> images;
+        PacketParser parser[2];
+        MessageAssembler assembler[2];
+        std::optional<std::string> request;
+        std::optional<TableImage> partial;
+        const auto flush = [&]{
+            if (partial)
+                images.push_back(std::move(*partial));
+            partial.reset();
+        };
+        const auto feed = [&](int direction, const std::string& bytes) {
+            for (const auto& pkt : parser[direction].feed(bytes)) {
+                auto msg{assembler[direction].add(pkt)};
+                if (!msg || msg->empty())
+                    continue;
+                if (direction == 0) {
+                    request = std::move(msg);
+                    continue;
+                }
+                if (!request)
+                    continue;
+                const auto req = [&request](std::size_t i) -> unsigned {
+                    return i < request->size() ? static_cast<uint8_t>((*request)[i]) : 0u;
+                };
+                const unsigned code{req(0)};
+                if ((code == 0x30 || code == 0x3F) && (*msg)[0] == 0 && msg->size() >= 4) {
+                    std::size_t count{static_cast<std::size_t>(uint8_t((*msg)[1]) << 8 | uint8_t((*msg)[2]))};
+                    if (msg->size() >= count + 4) {
+                        int number = req(1) << 8 | req(2);
+                        auto data{msg->substr(3, count)};
+                        std::size_t offset{code == 0x3F ? (req(3) << 16 | req(4) << 8 | req(5)) : 0u};
+                        if (code == 0x3F && partial && partial->number == number && partial->data.size() == offset) {
+                            partial->data += data;
+                        } else {
+                            flush();
+                            partial = TableImage{number, std::string(offset, '\0') + data};
+                            if (code == 0x30)
+                                flush();
+                        }
+                    }
+                }
+                request.reset();
+            }
+        };
+        if (isBinaryLog(log)) {
+            for (const auto& record : readBinaryLog(log)) {
+                if (record.kind == RecordKind::tx || record.kind == RecordKind::rx)
+                    feed(record.kind == RecordKind::tx ? 0 : 1, record.data);
+            }
+        } else {
+            std::string line, bytes;
+            while (std::getline(log, line)) {
+                int direction{parseLogLine(line, bytes)};
+                if (direction >= 0)
+                    feed(direction, bytes);
+            }
+        }
+        flush();
+        return images;
+    }
+}
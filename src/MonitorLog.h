@@ -0,0 +1,26 @@
+#ifndef MONITORLOG_H
+#define MONITORLOG_H
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace C12 {
+
+    struct TableImage {
+        int number;
+        std::string data;
+    };
+
+    /*
+     * Extracts the table read responses from a communication monitor
+     * log.  Lines holding a "Tx" or "Rx" marker followed by hex bytes are
+     * taken as channel traffic, which is split into C12.18 packets and
+     * matched up as read requests and their responses.  Partial reads of
+     * consecutive pieces of a table are joined into one image.  A binary
+     * log written by AsyncLog is recognized by its start and its tx and
+     * rx records are used the same way.
+     */
+    std::vector<TableImage> extractTableImages(std::istream& log);
+}
+
+#endif // MONITORLOG_H
@@ -0,0 +1,158 @@
+#include "ReadPlan.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace C12 {
+
+    bool Model::operator<(const Model& other) const {
+        return std::tie(manufacturer, model, firmware) < std::tie(other.manufacturer, other.model, other.firmware);
+    }
+
+    bool Model::operator==(const Model& other) const {
+        return std::tie(manufacturer, model, firmware) == std::tie(other.manufacturer, other.model, other.firmware);
+    }
+
+    static std::string trim(const std::string& str) {
+        static const char* blanks{" \t\r\n"};
+        auto first{str.find_first_not_of(blanks)};
+        if (first == std::string::npos)
+            return "";
+        return str.substr(first, str.find_last_not_of(blanks) + 1 - first);
+    }
+
+    static std::vector<std::string> words(const std::string& str) {
+        std::vector<std::string> list;
+        std::istringstream ss{str};
+        for (std::string word; ss >> word; )
+            list.push_back(word);
+        return list;
+    }
+
+    std::vector<std::string> PlanCache::firstRead(const std::string& meterName) const {
+        std::vector<std::string> items{"ST0", "ST1"};
+        std::lock_guard<std::mutex> guard{lock};
+        auto meter{meters.find(meterName)};
+        if (meter == meters.end())
+            return items;
+        auto plan{plans.find(meter->second)};
+        if (plan == plans.end())
+            return items;
+        for (const auto& item : plan->second) {
+            if (std::find(items.begin(), items.end(), item) == items.end())
+                items.push_back(item);
+        }
+        return items;
+    }
+
+    bool PlanCache::learn(const std::string& meterName, const Model& model, const std::vector<std::string>& tables) {
+        // a meter whose ST0 or ST1 could not be read teaches nothing
+        if (model.empty() || tables.empty())
+            return false;
+        std::lock_guard<std::mutex> guard{lock};
+        auto& known{meters[meterName]};
+        auto& plan{plans[model]};
+        bool changed{known != model || plan != tables};
+        known = model;
+        plan = tables;
+        return changed;
+    }
+
+    void PlanCache::forget(const std::string& meterName) {
+        std::lock_guard<std::mutex> guard{lock};
+        meters.erase(meterName);
+    }
+
+    void PlanCache::read(std::istream& in) {
+        std::lock_guard<std::mutex> guard{lock};
+        Model model;
+        std::vector<std::string> tables;
+        std::vector<std::string> names;
+        bool inModel{false};
+        const auto flush = [&]{
+            if (inModel) {
+                plans[model] = tables;
+                for (const auto& name : names)
+                    meters[name] = model;
+            }
+            model = Model{};
+            tables.clear();
+            names.clear();
+        };
+        std::string line;
+        for (unsigned lineNumber{1}; std::getline(in, line); ++lineNumber) {
+            const auto error = [lineNumber](const std::string& what) {
+                return std::runtime_error("line " + std::to_string(lineNumber) + ": " + what);
+            };
+            line = trim(line);
+            if (line.empty() || line[0] == ';' || line[0] == '#')
+                continue;
+            if (line[0] == '[') {
+                if (line != "[model]")
+                    throw error("the only section expected is [model]");
+                flush();
+                inModel = true;
+                continue;
+            }
+            auto eq{line.find('=')};
+            if (eq == std::string::npos)
+                throw error("NAME=VALUE expected");
+            if (!inModel)
+                throw error("value outside of a section");
+            auto name{trim(line.substr(0, eq))};
+            auto value{trim(line.substr(eq + 1))};
+            if (name == "MANUFACTURER")
+                model.manufacturer = value;
+            else if (name == "ED_MODEL")
+                model.model = value;
+            else if (name == "FIRMWARE")
+                model.firmware = value;
+            else if (name == "TABLES")
+                tables = words(value);
+            else if (name == "METERS")
+                names = words(value);
+            else
+                throw error("unknown name " + name);
+        }
+        flush();
+    }
+
+    void PlanCache::read(const std::string& fileName) {
+        std::ifstream in{fileName};
+        if (!in)
+            return;
+        try {
+            read(in);
+        }
+        catch (std::runtime_error& ex) {
+            throw std::runtime_error(fileName + ", " + ex.what());
+        }
+    }
+
+    void PlanCache::write(std::ostream& out) const {
+        std::lock_guard<std::mutex> guard{lock};
+        for (const auto& [model, tables] : plans) {
+            out << "[model]\n"
+                << "MANUFACTURER=" << model.manufacturer << '\n'
+                << "ED_MODEL=" << model.model << '\n'
+                << "FIRMWARE=" << model.firmware << '\n'
+                << "TABLES=";
+            const char* separator{""};
+            for (const auto& item : tables) {
+                out << separator << item;
+                separator = " ";
+            }
+            out << "\nMETERS=";
+            separator = "";
+            for (const auto& [name, known] : meters) {
+                if (known == model) {
+                    out << separator << name;
+                    separator = " ";
+                }
+            }
+            out << "\n\n";
+        }
+    }
+}
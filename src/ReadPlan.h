@@ -0,0 +1,58 @@
+#ifndef READPLAN_H
+#define READPLAN_H
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace C12 {
+
+    /* what GENERAL_MFG_ID_TBL says a meter is */
+    struct Model {
+        std::string manufacturer{};
+        std::string model{};
+        std::string firmware{};         // FW_VERSION_NUMBER.FW_REVISION_NUMBER
+        bool empty() const { return manufacturer.empty() && model.empty() && firmware.empty(); }
+        bool operator<(const Model& other) const;
+        bool operator==(const Model& other) const;
+        bool operator!=(const Model& other) const { return !(*this == other); }
+    };
+
+    /*
+     * The tables meters of each model use, as listed by GEN_CONFIG_TBL,
+     * and the model each meter was when it was last read.  Meters of one
+     * model and firmware nearly always use the same tables, so automatic
+     * mode can read them in the same session as ST0 instead of after it,
+     * and then check the plan against that ST0.  The file looks like
+     *
+     *     [model]
+     *     MANUFACTURER=EE
+     *     ED_MODEL=KV2
+     *     FIRMWARE=3.1
+     *     TABLES=ST0 ST1 ST2 ST3 MT0
+     *     METERS=north-1 north-2
+     *
+     * Its methods may be called from the threads of a fleet read.
+     */
+    class PlanCache {
+    public:
+        // ST0 and ST1 followed by the tables planned for the named meter
+        std::vector<std::string> firstRead(const std::string& meterName) const;
+        // records the tables a meter of a model uses, true if the plan changed
+        bool learn(const std::string& meterName, const Model& model, const std::vector<std::string>& tables);
+        // drops the plan of a meter, as after its planned read failed
+        void forget(const std::string& meterName);
+        // throws std::runtime_error naming the line of a malformed file
+        void read(std::istream& in);
+        // a file that does not exist yet is an empty cache
+        void read(const std::string& fileName);
+        void write(std::ostream& out) const;
+    private:
+        mutable std::mutex lock{};
+        std::map<Model, std::vector<std::string>> plans{};
+        std::map<std::string, Model> meters{};
+    };
+}
+
+#endif // READPLAN_H
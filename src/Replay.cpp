@@ -0,0 +1,73 @@
+#include "Replay.h"
+#include "MonitorLog.h"
+#include "C12Meter.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace C12 {
+
+    std::vector<std::string> replayFiles(const std::string& path) {
+        std::vector<std::string> files;
+        if (std::filesystem::is_directory(path)) {
+            for (const auto& entry : std::filesystem::directory_iterator(path)) {
+                if (entry.is_regular_file())
+                    files.push_back(entry.path().string());
+            }
+            std::sort(files.begin(), files.end());
+        } else {
+            files.push_back(path);
+        }
+        return files;
+    }
+
+    static ReplayResult replayOne(const std::string& file) {
+        ReplayResult result;
+        result.file = file;
+        std::ostringstream out;
+        auto start{std::chrono::steady_clock::now()};
+        try {
+            std::ifstream log{file, std::ios::binary};
+            if (!log) {
+                result.error = "cannot open " + file;
+                return result;
+            }
+            Meter meter{out};
+            meter.useArena();
+            for (const auto& image : extractTableImages(log)) {
+                out << (image.number >= 2048 ? "MT" : "ST") << (image.number & 2047) << ":\n";
+                meter.interpret(image.number, image.data);
+                ++result.tables;
+            }
+        }
+        catch (std::exception& ex) {
+            result.error = ex.what();
+        }
+        result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        result.output = out.str();
+        return result;
+    }
+
+    std::vector<ReplayResult> replay(const std::vector<std::string>& files, unsigned threads) {
+        std::vector<ReplayResult> results(files.size());
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min<std::size_t>(threads, std::max<std::size_t>(files.size(), 1));
+        std::atomic<std::size_t> next{0};
+        const auto worker = [&]{
+            for (auto i{next++}; i < files.size(); i = next++) {
+                results[i] = replayOne(files[i]);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned i{1}; i < threads; ++i)
+            pool.emplace_back(worker);
+        worker();
+        for (auto& t : pool)
+            t.join();
+        return results;
+    }
+}
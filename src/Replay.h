@@ -0,0 +1,29 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace C12 {
+
+    struct ReplayResult {
+        std::string file{};
+        std::string output{};
+        std::size_t tables = 0;
+        std::chrono::microseconds elapsed{0};
+        std::string error{};
+    };
+
+    // a log file name, or every regular file in a directory, in name order
+    std::vector<std::string> replayFiles(const std::string& path);
+
+    /*
+     * Decodes the tables found in each log as a fresh Meter would after
+     * reading them, without any channel.  Files are spread over the given
+     * number of threads, or over every core when it is zero, and the
+     * results are returned in the same order as the files.
+     */
+    std::vector<ReplayResult> replay(const std::vector<std::string>& files, unsigned threads = 0);
+}
+
+#endif // REPLAY_H
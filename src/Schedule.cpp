@@ -0,0 +1,61 @@
+#include "Schedule.h"
+#include <algorithm>
+
+namespace C12 {
+
+    void Schedule::add(std::string item, std::chrono::seconds interval, clock::time_point first) {
+        entries.push_back(Entry{std::move(item), std::max(interval, std::chrono::seconds{1}), first});
+    }
+
+    std::vector<std::string> Schedule::due(clock::time_point now) {
+        std::vector<std::string> items;
+        for (auto& entry : entries) {
+            if (entry.due <= now) {
+                items.push_back(entry.item);
+                entry.due += entry.interval;
+                if (entry.due <= now)
+                    entry.due = now + entry.interval;
+            }
+        }
+        return items;
+    }
+
+    Schedule::clock::time_point Schedule::next() const {
+        auto soonest{clock::time_point::max()};
+        for (const auto& entry : entries)
+            soonest = std::min(soonest, entry.due);
+        return soonest;
+    }
+
+    Priorities::Priorities()
+        : priority{{"ST0", 100}, {"ST1", 100}, {"ST52", 50}, {"ST55", 50}, {"ST21", 40}, {"ST23", 40}} {}
+
+    void Priorities::set(const std::string& item, int value) {
+        priority[item] = value;
+    }
+
+    int Priorities::of(const std::string& item) const {
+        auto it{priority.find(item)};
+        return it == priority.end() ? 0 : it->second;
+    }
+
+    static bool isFunction(const std::string& item) {
+        return item.size() > 1 && item[1] == 'F';
+    }
+
+    std::vector<std::size_t> Priorities::order(const std::vector<std::string>& items) const {
+        std::vector<std::size_t> positions;
+        for (std::size_t i{0}; i < items.size(); ++i)
+            positions.push_back(i);
+        const auto higher = [&](std::size_t a, std::size_t b) { return of(items[a]) > of(items[b]); };
+        auto from{positions.begin()};
+        for (auto it{positions.begin()}; it != positions.end(); ++it) {
+            if (isFunction(items[*it])) {
+                std::stable_sort(from, it, higher);
+                from = it + 1;
+            }
+        }
+        std::stable_sort(from, positions.end(), higher);
+        return positions;
+    }
+}
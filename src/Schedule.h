@@ -0,0 +1,54 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace C12 {
+
+    /*
+     * Read schedule for polling mode.  Each item, such as "ST3", is read
+     * every interval, starting with the first poll.  If polling falls
+     * behind, missed reads are skipped rather than run back to back.
+     */
+    class Schedule {
+    public:
+        using clock = std::chrono::steady_clock;
+        void add(std::string item, std::chrono::seconds interval, clock::time_point first = clock::now());
+        // items that are due at the given time, which are then rescheduled
+        std::vector<std::string> due(clock::time_point now);
+        clock::time_point next() const;
+        bool empty() const { return entries.empty(); }
+    private:
+        struct Entry {
+            std::string item;
+            std::chrono::seconds interval;
+            clock::time_point due;
+        };
+        std::vector<Entry> entries{};
+    };
+
+    /*
+     * Priorities of the items of a session, read highest first.  ST0
+     * and ST1 come first as every other table is decoded with them, then
+     * the clock, ST52 and ST55, then the billing registers of ST23 with
+     * ST21, which gives their shape.  Anything else, such as a
+     * configuration table, has priority 0 unless it is set.  A function
+     * may change what a later read returns, so items never move across
+     * one; ordering applies between functions.
+     */
+    class Priorities {
+    public:
+        Priorities();
+        void set(const std::string& item, int priority);
+        int of(const std::string& item) const;
+        // positions of items in the order to read them, equal priorities keeping their given order
+        std::vector<std::size_t> order(const std::vector<std::string>& items) const;
+    private:
+        std::map<std::string, int> priority{};
+    };
+}
+
+#endif // SCHEDULE_H
@@ -0,0 +1,148 @@
+#include "SessionStats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace C12 {
+
+    static constexpr unsigned subBuckets{16};
+
+    static std::size_t bucketIndex(uint64_t v) {
+        if (v < subBuckets)
+            return v;
+        unsigned e{0};
+        while ((v >> e) >= 2 * subBuckets)
+            ++e;
+        return subBuckets * (e + 1) + ((v >> e) - subBuckets);
+    }
+
+    // the largest value which falls in the bucket
+    static uint64_t bucketLimit(std::size_t index) {
+        if (index < subBuckets)
+            return index;
+        std::size_t e{index / subBuckets - 1};
+        uint64_t sub{index % subBuckets};
+        return ((subBuckets + sub + 1) << e) - 1;
+    }
+
+    void Histogram::add(std::chrono::microseconds t) {
+        auto v{static_cast<uint64_t>(std::max<std::chrono::microseconds::rep>(t.count(), 0))};
+        auto i{bucketIndex(v)};
+        if (i >= buckets.size())
+            buckets.resize(i + 1);
+        ++buckets[i];
+        ++n;
+        sum += t;
+        largest = std::max(largest, t);
+    }
+
+    std::chrono::microseconds Histogram::percentile(double p) const {
+        if (n == 0)
+            return std::chrono::microseconds{0};
+        auto rank{static_cast<std::size_t>(std::ceil(p / 100.0 * n))};
+        rank = std::max<std::size_t>(rank, 1);
+        std::size_t seen{0};
+        for (std::size_t i{0}; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                return std::min(largest, std::chrono::microseconds(bucketLimit(i)));
+            }
+        }
+        return largest;
+    }
+
+    void SessionStats::Totals::add(const PhaseSample& sample) {
+        latency.add(sample.elapsed);
+        bytesSent += sample.bytesSent;
+        bytesReceived += sample.bytesReceived;
+        retries += sample.retries;
+        allocations += sample.allocations;
+    }
+
+    void SessionStats::record(Phase phase, const std::string& item, const PhaseSample& sample) {
+        phases[phase].add(sample);
+        if (phase == Phase::Read)
+            reads[item].add(sample);
+        else if (phase == Phase::Decode)
+            decodes[item].add(sample);
+    }
+
+    void SessionStats::sessionDone(bool failed) {
+        ++sessionCount;
+        if (failed)
+            ++failureCount;
+    }
+
+    const Histogram& SessionStats::histogram(Phase phase) const {
+        static const Histogram empty;
+        auto it{phases.find(phase)};
+        return it == phases.end() ? empty : it->second.latency;
+    }
+
+    std::size_t SessionStats::bytes(Phase phase) const {
+        auto it{phases.find(phase)};
+        return it == phases.end() ? 0 : it->second.bytesSent + it->second.bytesReceived;
+    }
+
+    unsigned SessionStats::retries(Phase phase) const {
+        auto it{phases.find(phase)};
+        return it == phases.end() ? 0 : it->second.retries;
+    }
+
+    static const char* phaseName(Phase phase) {
+        switch (phase) {
+        case Phase::Connect: return "connect";
+        case Phase::StartSession: return "start_session";
+        case Phase::Read: return "read";
+        case Phase::EndSession: return "end_session";
+        case Phase::Decode: return "decode";
+        case Phase::Session: return "session";
+        }
+        return "unknown";
+    }
+
+    static std::string quoted(const std::string& s) {
+        std::string q{"\""};
+        for (char ch : s) {
+            if (ch == '"' || ch == '\\')
+                q.push_back('\\');
+            q.push_back(ch);
+        }
+        return q + '"';
+    }
+
+    template <class Totals>
+    static void writeTotals(std::ostream& out, const Totals& t) {
+        out << "{\"count\": " << t.latency.count()
+            << ", \"p50_us\": " << t.latency.percentile(50).count()
+            << ", \"p95_us\": " << t.latency.percentile(95).count()
+            << ", \"p99_us\": " << t.latency.percentile(99).count()
+            << ", \"max_us\": " << t.latency.max().count()
+            << ", \"total_us\": " << t.latency.total().count()
+            << ", \"bytes_sent\": " << t.bytesSent
+            << ", \"bytes_received\": " << t.bytesReceived
+            << ", \"retries\": " << t.retries
+            << ", \"allocations\": " << t.allocations << "}";
+    }
+
+    template <class Map, class Name>
+    static void writeGroup(std::ostream& out, const char* title, const Map& group, Name name) {
+        out << "  " << quoted(title) << ": {";
+        const char* sep{"\n"};
+        for (const auto& entry : group) {
+            out << sep << "    " << quoted(name(entry.first)) << ": ";
+            writeTotals(out, entry.second);
+            sep = ",\n";
+        }
+        out << (group.empty() ? "}" : "\n  }");
+    }
+
+    std::ostream& SessionStats::writeJson(std::ostream& out) const {
+        out << "{\n  \"sessions\": " << sessionCount << ",\n  \"failures\": " << failureCount << ",\n";
+        writeGroup(out, "phases", phases, [](Phase p){ return std::string{phaseName(p)}; });
+        out << ",\n";
+        writeGroup(out, "reads", reads, [](const std::string& s){ return s; });
+        out << ",\n";
+        writeGroup(out, "decodes", decodes, [](const std::string& s){ return s; });
+        return out << "\n}\n";
+    }
+}
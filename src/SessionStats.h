@@ -0,0 +1,73 @@
+#ifndef SESSIONSTATS_H
+#define SESSIONSTATS_H
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace C12 {
+
+    /*
+     * Latency histogram with bounded memory.  Values below 16 us are
+     * kept exactly and larger ones in 16 buckets per power of two, so a
+     * reported percentile is within about 6% of the true value.
+     */
+    class Histogram {
+    public:
+        void add(std::chrono::microseconds t);
+        std::size_t count() const { return n; }
+        std::chrono::microseconds total() const { return sum; }
+        std::chrono::microseconds max() const { return largest; }
+        std::chrono::microseconds percentile(double p) const;
+    private:
+        std::vector<std::size_t> buckets{};
+        std::size_t n = 0;
+        std::chrono::microseconds sum{0};
+        std::chrono::microseconds largest{0};
+    };
+
+    enum class Phase { Connect, StartSession, Read, EndSession, Decode, Session };
+
+    /* what happened in one phase: how long it took and what crossed the link */
+    struct PhaseSample {
+        std::chrono::microseconds elapsed{0};
+        std::size_t bytesSent = 0;
+        std::size_t bytesReceived = 0;
+        unsigned retries = 0;
+        std::size_t allocations = 0;    // heap allocations for tables
+    };
+
+    /*
+     * Collects per phase timing over one or more meter sessions, both by
+     * phase and, for reads and decodes, by table, and writes the result
+     * as JSON.
+     */
+    class SessionStats {
+    public:
+        void record(Phase phase, const std::string& item, const PhaseSample& sample);
+        void sessionDone(bool failed);
+        std::ostream& writeJson(std::ostream& out) const;
+        unsigned sessions() const { return sessionCount; }
+        unsigned failures() const { return failureCount; }
+        const Histogram& histogram(Phase phase) const;
+        std::size_t bytes(Phase phase) const;
+        unsigned retries(Phase phase) const;
+    private:
+        struct Totals {
+            Histogram latency{};
+            std::size_t bytesSent = 0;
+            std::size_t bytesReceived = 0;
+            unsigned retries = 0;
+            std::size_t allocations = 0;
+            void add(const PhaseSample& sample);
+        };
+        std::map<Phase, Totals> phases{};
+        std::map<std::string, Totals> reads{};
+        std::map<std::string, Totals> decodes{};
+        unsigned sessionCount = 0;
+        unsigned failureCount = 0;
+    };
+}
+
+#endif // SESSIONSTATS_H
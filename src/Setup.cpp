@@ -1,11 +1,58 @@
 #include <MCOM/MCOMExtern.h>
 #include <MCOM/MCOM.h>
 #include "Setup.h"
+#include "AsyncLog.h"
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
 
 const MStdString s_defaultIniFileName = "default.ini";
 const MStdString s_defaultChannelProperties = "TYPE=CHANNEL_OPTICAL_PROBE";
 const MStdString s_defaultProtocolProperties = "TYPE=PROTOCOL_ANSI_C12_18";
 
+#if !M_NO_MCOM_MONITOR
+// Monitor that only copies each message into the ring of a C12::AsyncLog,
+// whose own thread writes it to the file.  The links of --window share the
+// monitor from threads of their own, so producers take turns; the writer
+// thread never takes this lock, so a slow disk does not hold it.
+//
+class AsyncMonitor : public MMonitor
+{
+public:
+
+   AsyncMonitor(const MStdString& fileName, const C12::AsyncLog::Options& options)
+   :
+      m_log(fileName, options)
+   {
+   }
+
+   virtual bool IsListening() const
+   {
+      return true;
+   }
+
+   virtual void Write(MessageKind kind, const char* data, unsigned size)
+   {
+      C12::RecordKind recordKind = C12::RecordKind::text;
+      if ( kind == MessageChannelByteTx )
+         recordKind = C12::RecordKind::tx;
+      else if ( kind == MessageChannelByteRx )
+         recordKind = C12::RecordKind::rx;
+      else if ( kind == MessageError )
+         recordKind = C12::RecordKind::error;
+      std::lock_guard<std::mutex> lock(m_lock);
+      m_log.write(recordKind, data, size);
+   }
+
+private:
+
+   std::mutex    m_lock;
+   C12::AsyncLog m_log;
+};
+#endif
+
 Setup::Setup()
 :
    m_protocol(nullptr),
@@ -13,13 +60,41 @@ Setup::Setup()
    m_tables(),
    m_verbose(false),
    m_single(false),
-   m_fullauto(false)
+   m_fullauto(false),
+   m_arena(false),
+   m_chunked(false),
+   m_changes(false),
+   m_replayPath(),
+   m_gatewayPath(),
+   m_sharedMemoryName(),
+   m_statisticsFileName(),
+   m_daemon(false),
+   m_pollInterval(60),
+   m_iterations(0),
+   m_duration(0),
+   m_schedule(),
+   m_priorities(),
+   m_deadline(0),
+   m_fleetFileName(),
+   m_planFileName(),
+   m_reuseConnections(false),
+   m_window(1),
+   m_jobs(4),
+   m_definitions(),
+   m_emulatorSettings()
+#if !M_NO_MCOM_MONITOR
+   , m_asyncMonitor()
+#endif
 {
 }
 
 Setup::~Setup()
 {
    delete m_protocol;
+#if !M_NO_MCOM_MONITOR
+   if ( m_asyncMonitor != nullptr && m_channel != nullptr )
+      m_channel->SetMonitor(nullptr); // the log is drained and closed when m_asyncMonitor goes
+#endif
    delete m_channel;
 }
 
@@ -30,9 +105,18 @@ bool Setup::Initialize(int argc, char** argv)
    MStdString channelProperties  = s_defaultChannelProperties;
    MStdString protocolProperties = s_defaultProtocolProperties;
    MStdString iniFileName        = s_defaultIniFileName;
+   MStdString pollInterval;
+   MStdString iterations;
+   MStdString deadline;
+   MStdString duration;
+   MStdString jobs;
+   MStdString window;
+   MStdString definitions;
 #if !M_NO_MCOM_MONITOR
    MStdString monitorFileName;
    MStdString monitorAddress;
+   MStdString monitorBinaryFileName;
+   MStdString monitorOverflow;
 #endif
    try
    {
@@ -44,9 +128,33 @@ bool Setup::Initialize(int argc, char** argv)
       parser.DeclareFlag('v', "verbose", "Full diagnostic output", m_verbose);
       parser.DeclareFlag('s', "single", "Read single tables, skipping over errors", m_single);
       parser.DeclareFlag('A', "automatic", "Fully automatic mode", m_fullauto);
+      parser.DeclareFlag('M', "arena", "Build the tables of each meter in one arena, freed all at once", m_arena);
+      parser.DeclareFlag('k', "chunked", "Read tables in chunks that fit one response, printing large ones as they arrive", m_chunked);
+      parser.DeclareFlag('u', "changes", "Print a table read before as only the fields that changed since", m_changes);
+      parser.DeclareFlag('d', "daemon", "Stay resident and poll the tables in the [schedule] section", m_daemon);
+      parser.DeclareNamedString('i', "interval", "seconds", "Polling interval for tables given on the command line, default 60", pollInterval);
+      parser.DeclareNamedString('n', "iterations", "count", "Repeat the read this many times and report the throughput", iterations);
+      parser.DeclareNamedString('T', "duration", "seconds", "Repeat the read for this long and report the throughput", duration);
+      parser.DeclareNamedString('e', "deadline", "milliseconds", "Stop reading this long after a session starts, highest priority items first", deadline);
+      parser.DeclareNamedString('S', "statistics", "file-name", "Time each phase of the session and write statistics as JSON", m_statisticsFileName);
+      parser.DeclareNamedString('F', "fleet", "file-name", "Read every meter listed in a fleet file", m_fleetFileName);
+      parser.DeclareFlag('R', "reuse-connections", "Keep the channels of a fleet open for later meters with the same channel properties", m_reuseConnections);
+      parser.DeclareNamedString('P', "plans", "file-name", "Remember the tables each meter model uses, so that --automatic reads them with ST0", m_planFileName);
+      parser.DeclareNamedString('j', "jobs", "count", "How many meters of a fleet to read at once, default 4", jobs);
+      parser.DeclareNamedString('w', "window", "count", "How many sessionless C12.22 requests to keep in flight, each on its own link, default 1", window);
+      parser.DeclareNamedString('D', "definitions", "file-names", "Load table layouts from TDL files or plugins, separated by ';'", definitions);
+#if C12_GATEWAY
+      parser.DeclareNamedString('g', "gateway", "socket-path", "After the first read, answer queries on this Unix socket, sharing reads between them", m_gatewayPath);
+#endif
+#if C12_SHARED_TABLES
+      parser.DeclareNamedString('x', "shared-memory", "name", "Publish the tables after each read in this shared memory segment, such as /c12test", m_sharedMemoryName);
+#endif
+      parser.DeclareNamedString('r', "replay", "path", "Decode table reads from a monitor log or directory of logs, no channel is used", m_replayPath);
 #if !M_NO_MCOM_MONITOR
       parser.DeclareNamedString('f', "monitor-file",    "file-name", "Store communication log to ml file", monitorFileName);
       parser.DeclareNamedString('a', "monitor-address", "file-name", "Send monitor data to this address", monitorAddress);
+      parser.DeclareNamedString('b', "monitor-binary",  "file-name", "Store communication log to a binary file from a background thread", monitorBinaryFileName);
+      parser.DeclareNamedString('o', "monitor-overflow", "policy", "When the binary log falls behind, drop messages or wait for it, default drop", monitorOverflow);
 #endif
       parser.DeclareStringVector("tables-functions", "Tables to read and/or functions to execute", m_tables);
       parser.SetFooter("Channel properties example:\n"
@@ -65,6 +173,33 @@ bool Setup::Initialize(int argc, char** argv)
 
       parser.WriteHeader();
 
+      if ( !pollInterval.empty() )
+         m_pollInterval = MToUnsignedLong(pollInterval);
+      if ( !iterations.empty() )
+         m_iterations = MToUnsignedLong(iterations);
+      if ( !duration.empty() )
+         m_duration = MToUnsignedLong(duration);
+      if ( (m_iterations != 0 || m_duration != 0) && (m_daemon || !m_fleetFileName.empty() || !m_replayPath.empty()) )
+         MException::Throw("Soak runs repeat a single meter read, not --daemon, --fleet or --replay");
+      if ( !m_gatewayPath.empty() && (m_daemon || m_iterations != 0 || m_duration != 0 || !m_fleetFileName.empty() || !m_replayPath.empty()) )
+         MException::Throw("The gateway serves a single meter, not --daemon, a soak run, --fleet or --replay");
+      if ( !m_sharedMemoryName.empty() && (!m_fleetFileName.empty() || !m_replayPath.empty()) )
+         MException::Throw("Shared memory publishes the tables of a single meter, not --fleet or --replay");
+      if ( !deadline.empty() )
+         m_deadline = MToUnsignedLong(deadline);
+      if ( !jobs.empty() )
+         m_jobs = MToUnsignedLong(jobs);
+      if ( m_jobs == 0 )
+         MException::Throw("At least one job is needed");
+      if ( !window.empty() )
+         m_window = MToUnsignedLong(window);
+      if ( m_window == 0 )
+         MException::Throw("The window needs room for at least one request");
+      std::istringstream names(definitions);
+      for ( MStdString name; std::getline(names, name, ';'); )
+         if ( !name.empty() )
+            m_definitions.push_back(name);
+
       if ( iniFileName != s_defaultIniFileName || MUtilities::IsPathExisting(iniFileName) ) // default.ini can be absent but any other ini can not
          DoReadIni(iniFileName);
 
@@ -78,6 +213,9 @@ bool Setup::Initialize(int argc, char** argv)
       else if ( channelProperties != s_defaultChannelProperties )
          m_channel->SetPersistentPropertyValues(channelProperties);
 
+      if ( !m_emulatorSettings.empty() )
+         DoStartLinkEmulator();
+
       m_protocol->SetIsChannelOwned(false);
       m_protocol->SetChannel(m_channel);
 
@@ -94,6 +232,25 @@ bool Setup::Initialize(int argc, char** argv)
       }
       if ( monitor != nullptr )
          m_channel->SetMonitor(monitor);
+      if ( !monitorBinaryFileName.empty() )
+      {
+         if ( monitor != nullptr )
+            MException::Throw("The binary log can not be combined with --monitor-file or --monitor-address");
+         C12::AsyncLog::Options options;
+         if ( monitorOverflow == "wait" )
+            options.overflow = C12::Overflow::wait;
+         else if ( !monitorOverflow.empty() && monitorOverflow != "drop" )
+            MException::Throw("Monitor overflow policy can only be drop or wait");
+         try
+         {
+            m_asyncMonitor.reset(M_NEW AsyncMonitor(monitorBinaryFileName, options));
+         }
+         catch ( std::runtime_error& ex )
+         {
+            MException::Throw(ex.what());
+         }
+         m_channel->SetMonitor(m_asyncMonitor.get());
+      }
 #endif
    }
    catch ( MException& ex )
@@ -135,9 +292,11 @@ void Setup::DoReadIniDetermineTypes(MIniFile& iniFile)
             parsing = ParsingProtocol;
          else if ( key == "channel" )
             parsing = ParsingChannel;
+         else if ( key == "schedule" || key == "priority" )
+            parsing = ParsingNone;  // collected in the second pass
          else
          {
-            iniFile.ThrowError("Keys expected are only [protocol] or [channel], case sensitive");
+            iniFile.ThrowError("Keys expected are only [protocol], [channel], [schedule] or [priority], case sensitive");
             M_ENSURED_ASSERT(0);
          }
       }
@@ -195,6 +354,8 @@ void Setup::DoReadIniDetermineTypes(MIniFile& iniFile)
 void Setup::DoReadIniPopulateValues(MIniFile& iniFile)
 {
    MCOMObject* obj = nullptr;
+   bool schedule = false;
+   bool priority = false;
    for ( ;; )    // Second pass, collect properties
    {
       MIniFile::LineType type = iniFile.ReadLine();
@@ -203,20 +364,92 @@ void Setup::DoReadIniPopulateValues(MIniFile& iniFile)
       if ( type == MIniFile::LineKey )
       {
          const MStdString& key = iniFile.GetKey();
+         schedule = key == "schedule";
+         priority = key == "priority";
          if ( key == "protocol" )
             obj = m_protocol;
          else if ( key == "channel" )
             obj = m_channel;
+         else if ( schedule || priority )
+            obj = nullptr;
          else
          {
             M_ASSERT(0); // this condition was already reported
          }
       }
+      else if ( schedule && type == MIniFile::LineNameValue )
+      {
+         // table or function to read, and the interval in seconds, such as ST3=60
+         m_schedule.emplace_back(iniFile.GetName(), MToUnsignedLong(iniFile.GetStringValue()));
+      }
+      else if ( priority && type == MIniFile::LineNameValue )
+      {
+         // table or function and its priority, higher read first, such as ST23=40
+         m_priorities.emplace_back(iniFile.GetName(), static_cast<int>(MToLong(iniFile.GetStringValue())));
+      }
       else if ( obj != nullptr && type == MIniFile::LineNameValue )
       {
          const MStdString& name = iniFile.GetName();
-         if ( name != "CONFIGURATION" && name != "Configuration" )
+         if ( obj == m_channel && name.compare(0, 8, "EMULATOR") == 0 )
+            m_emulatorSettings[name] = iniFile.GetStringValue();   // not a channel property, see DoStartLinkEmulator
+         else if ( name != "CONFIGURATION" && name != "Configuration" )
             obj->SetProperty(name, iniFile.GetValue());
       }
    }
 }
+
+// Put an emulated link between the channel and either a simulated meter or a peer device.
+// The [channel] section selects it with EMULATOR=LOOPBACK, EMULATOR=PTY or EMULATOR=<device>,
+// and the channel, which should be a serial type, is pointed at the emulator's pseudo terminal.
+//
+void Setup::DoStartLinkEmulator()
+{
+#if C12_LINK_EMULATOR
+   C12::LinkModel model;
+   MStdString peer;
+   MStdString tableDirectory;
+   try
+   {
+      for ( const auto& setting : m_emulatorSettings )
+      {
+         const MStdString& name = setting.first;
+         const MStdString& value = setting.second;
+         if ( name == "EMULATOR" )
+            peer = value;
+         else if ( name == "EMULATOR_BAUD" )
+            model.baud = std::stoul(value);
+         else if ( name == "EMULATOR_BYTE_DELAY" )
+            model.byteDelay = std::chrono::microseconds(std::stoul(value));
+         else if ( name == "EMULATOR_TURN_AROUND" )
+            model.turnAround = std::chrono::microseconds(std::stoul(value) * 1000);
+         else if ( name == "EMULATOR_BIT_ERROR_RATE" )
+            model.bitErrorRate = std::stod(value);
+         else if ( name == "EMULATOR_DROP_RATE" )
+            model.dropRate = std::stod(value);
+         else if ( name == "EMULATOR_SEED" )
+            model.seed = std::stoul(value);
+         else if ( name == "EMULATOR_TABLES" )
+            tableDirectory = value;
+         else
+            MException::Throw("Unknown link emulator setting " + name);
+      }
+      m_emulator.reset(new C12::LinkEmulator(model));
+      m_emulator->open(peer, tableDirectory);
+   }
+   catch ( std::logic_error& ex )   // from std::stoul and std::stod
+   {
+      MException::Throw(MStdString("Bad link emulator setting: ") + ex.what());
+   }
+   catch ( std::system_error& ex )
+   {
+      MException::Throw(MStdString("Cannot start link emulator: ") + ex.what());
+   }
+   m_channel->SetProperty("PORT_NAME", m_emulator->portName());
+   std::cout << "Link emulator on " << m_emulator->portName();
+   if ( !m_emulator->peerName().empty() )
+      std::cout << ", peer on " << m_emulator->peerName();
+   std::cout << '\n';
+#else
+   MException::Throw("Link emulator is not supported on this platform");
+#endif
+}
@@ -2,6 +2,13 @@
 #define SETUP_H
 
 #include <MCOM/MCOM.h>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#if C12_LINK_EMULATOR
+#include "LinkEmulator.h"
+#endif
 
 // Handle program parameters whether they appear from command line or configuration ini file
 //
@@ -56,11 +63,161 @@ public:
       return m_fullauto;
    }
 
+   /// Called after Initialize to get the value of arena flag
+   ///
+   bool GetArenaFlag() const
+   {
+      return m_arena;
+   }
+
+   /// Called after Initialize to get the value of chunked flag
+   ///
+   bool GetChunkedFlag() const
+   {
+      return m_chunked;
+   }
+
+   /// Called after Initialize to get the value of changes flag
+   ///
+   bool GetChangesFlag() const
+   {
+      return m_changes;
+   }
+
+   /// Called after Initialize to get the value of daemon flag
+   ///
+   bool GetDaemonFlag() const
+   {
+      return m_daemon;
+   }
+
+   /// Called after Initialize to get the polling interval in seconds for tables given on the command line
+   ///
+   unsigned GetPollInterval() const
+   {
+      return m_pollInterval;
+   }
+
+   /// Called after Initialize to get the tables and intervals in seconds from the [schedule] section
+   ///
+   const std::vector<std::pair<MStdString, unsigned>>& GetSchedule() const
+   {
+      return m_schedule;
+   }
+
+   /// Called after Initialize to get how many sessions a soak run repeats, 0 if not limited by count
+   ///
+   unsigned GetIterations() const
+   {
+      return m_iterations;
+   }
+
+   /// Called after Initialize to get how many seconds a soak run lasts, 0 if not limited by time
+   ///
+   unsigned GetDuration() const
+   {
+      return m_duration;
+   }
+
+   /// Called after Initialize to get the read priorities from the [priority] section
+   ///
+   const std::vector<std::pair<MStdString, int>>& GetPriorities() const
+   {
+      return m_priorities;
+   }
+
+   /// Called after Initialize to get how many milliseconds a session may read for, 0 if not limited
+   ///
+   unsigned GetDeadline() const
+   {
+      return m_deadline;
+   }
+
+   /// Called after Initialize to get the Unix socket on which to answer queries, empty if none
+   ///
+   const MStdString& GetGatewayPath() const
+   {
+      return m_gatewayPath;
+   }
+
+   /// Called after Initialize to get the shared memory segment in which to publish the tables, empty if none
+   ///
+   const MStdString& GetSharedMemoryName() const
+   {
+      return m_sharedMemoryName;
+   }
+
+   /// Called after Initialize to get the monitor log file or directory to replay, empty if none
+   ///
+   const MStdString& GetReplayPath() const
+   {
+      return m_replayPath;
+   }
+
+   /// Called after Initialize to get the file for timing statistics, empty if none
+   ///
+   const MStdString& GetStatisticsFileName() const
+   {
+      return m_statisticsFileName;
+   }
+
+   /// Called after Initialize to get the fleet file listing meters to read, empty if none
+   ///
+   const MStdString& GetFleetFileName() const
+   {
+      return m_fleetFileName;
+   }
+
+   /// Called after Initialize to get the value of reuse connections flag
+   ///
+   bool GetReuseConnectionsFlag() const
+   {
+      return m_reuseConnections;
+   }
+
+   /// Called after Initialize to get how many sessionless requests are kept in flight
+   ///
+   unsigned GetWindow() const
+   {
+      return m_window;
+   }
+
+   /// Called after Initialize to get the file of read plans for automatic mode, empty if none
+   ///
+   const MStdString& GetPlanFileName() const
+   {
+      return m_planFileName;
+   }
+
+   /// Called after Initialize to get how many meters of a fleet are read at once
+   ///
+   unsigned GetJobs() const
+   {
+      return m_jobs;
+   }
+
+   /// Called after Initialize to get the TDL files and plugins with table layouts to load
+   ///
+   const MStdStringVector& GetDefinitions() const
+   {
+      return m_definitions;
+   }
+
+#if C12_LINK_EMULATOR
+   /// Called after Initialize to get the link emulator, if the channel uses one
+   ///
+   const C12::LinkEmulator* GetLinkEmulator() const
+   {
+      return m_emulator.get();
+   }
+#endif
+
 private:
 
    void DoReadIni(const std::string& fileName);
    void DoReadIniDetermineTypes(MIniFile& iniFile);
    void DoReadIniPopulateValues(MIniFile& iniFile);
+   void DoStartLinkEmulator();
 
    MProtocol*       m_protocol;
    MChannel*        m_channel;
@@ -68,6 +225,33 @@ private:
    bool             m_verbose;
    bool             m_single;
    bool             m_fullauto;
+   bool             m_arena;
+   bool             m_chunked;
+   bool             m_changes;
+   MStdString       m_replayPath;
+   MStdString       m_gatewayPath;
+   MStdString       m_sharedMemoryName;
+   MStdString       m_statisticsFileName;
+   bool             m_daemon;
+   unsigned         m_pollInterval;
+   unsigned         m_iterations;
+   unsigned         m_duration;
+   std::vector<std::pair<MStdString, unsigned>> m_schedule;
+   std::vector<std::pair<MStdString, int>> m_priorities;
+   unsigned         m_deadline;
+   MStdString       m_fleetFileName;
+   MStdString       m_planFileName;
+   bool             m_reuseConnections;
+   unsigned         m_window;
+   unsigned         m_jobs;
+   MStdStringVector m_definitions;
+   std::map<MStdString, MStdString> m_emulatorSettings;
+#if !M_NO_MCOM_MONITOR
+   std::unique_ptr<MMonitor> m_asyncMonitor;
+#endif
+#if C12_LINK_EMULATOR
+   std::unique_ptr<C12::LinkEmulator> m_emulator;
+#endif
 };
 
 #endif // SETUP_H
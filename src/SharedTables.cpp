@@ -0,0 +1,434 @@
+#include "SharedTables.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace C12 {
+
+    static void throwErrno(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    namespace {
+        constexpr char magic[8]{'C', '1', '2', 'T', 'A', 'B', 'L', 'E'};
+        constexpr std::uint32_t formatVersion{2};
+
+        // at the start of the segment, followed by the two slots
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t slotSize;
+            std::atomic<std::uint64_t> generation;
+        };
+
+        // followed by count entries and then the names, images and layouts they refer to
+        struct Slot {
+            std::atomic<std::uint64_t> sequence;
+            std::uint64_t generation;
+            std::uint32_t count;
+            std::uint32_t used;
+        };
+
+        // offsets are from the start of the slot
+        struct Entry {
+            std::uint32_t number;
+            std::uint32_t nameOffset;
+            std::uint32_t nameSize;
+            std::uint32_t imageOffset;
+            std::uint32_t imageSize;
+            std::uint32_t layoutOffset;
+            std::uint32_t layoutSize;
+            std::uint32_t bigEndian;    // the order of the integers in the image
+        };
+
+        enum class Kind : std::uint8_t { UINT, SET, BINARY, STRING, BITFIELD, RECORD, ARRAY };
+    }
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "counts shared between processes must be lock free");
+
+    static Slot* slotOf(const void* segment, std::uint64_t generation) {
+        auto header{static_cast<const Header*>(segment)};
+        auto base{static_cast<const char*>(segment) + sizeof(Header) + (generation % 2) * header->slotSize};
+        return reinterpret_cast<Slot*>(const_cast<char*>(base));
+    }
+
+    /*
+     * A layout is published as what was given to Record::addField to
+     * build it: a record is its name, its number of fields and each
+     * field, and a field is its kind and name followed by its size, the
+     * subfields of a BITFIELD, the layout of a RECORD, or the count and
+     * element of an ARRAY.  Numbers are 32 bits in the host's order.
+     */
+    static void put(std::string& out, std::uint32_t number) {
+        out.append(reinterpret_cast<const char*>(&number), sizeof number);
+    }
+
+    static void put(std::string& out, const std::string& text) {
+        put(out, static_cast<std::uint32_t>(text.size()));
+        out += text;
+    }
+
+    static void put(std::string& out, Kind kind) {
+        out += static_cast<char>(kind);
+    }
+
+    static void encode(std::string& out, const Record& layout);
+
+    static void encode(std::string& out, const Field& fld) {
+        if (auto array = dynamic_cast<const ARRAY*>(&fld)) {
+            put(out, Kind::ARRAY);
+            put(out, fld.Name());
+            put(out, static_cast<std::uint32_t>(array->Count()));
+            encode(out, array->Element());
+        } else if (auto record = dynamic_cast<const RECORD*>(&fld)) {
+            put(out, Kind::RECORD);
+            put(out, fld.Name());
+            encode(out, *record->Layout());
+        } else if (auto bits = dynamic_cast<const BITFIELD*>(&fld)) {
+            put(out, Kind::BITFIELD);
+            put(out, fld.Name());
+            put(out, static_cast<std::uint32_t>(fld.size()));
+            put(out, static_cast<std::uint32_t>(bits->Subfields().size()));
+            for (const auto& sub : bits->Subfields()) {
+                put(out, sub.Name());
+                put(out, sub.StartBit());
+                put(out, sub.EndBit());
+            }
+        } else {
+            Kind kind;
+            if (dynamic_cast<const UINT*>(&fld))
+                kind = Kind::UINT;
+            else if (dynamic_cast<const SET*>(&fld))
+                kind = Kind::SET;
+            else if (dynamic_cast<const BINARY*>(&fld))
+                kind = Kind::BINARY;
+            else if (dynamic_cast<const STRING*>(&fld))
+                kind = Kind::STRING;
+            else
+                throw std::runtime_error("cannot publish the layout of field " + fld.Name());
+            put(out, kind);
+            put(out, fld.Name());
+            put(out, static_cast<std::uint32_t>(fld.size()));
+        }
+    }
+
+    static void encode(std::string& out, const Record& layout) {
+        put(out, layout.Name());
+        put(out, static_cast<std::uint32_t>(layout.size()));
+        for (const auto& fld : layout)
+            encode(out, *fld);
+    }
+
+    /* builds a Record from its published form, throwing if that is cut short or makes no sense */
+    class LayoutReader {
+    public:
+        explicit LayoutReader(std::string_view bytes) : bytes{bytes} {}
+        std::shared_ptr<const Record> record() {
+            auto layout{std::make_shared<Record>(text())};
+            for (auto n{number()}; n > 0; --n)
+                field(*layout);
+            return layout;
+        }
+        bool done() const { return bytes.empty(); }
+    private:
+        void field(Record& layout) {
+            auto kind{this->kind()};
+            auto name{text()};
+            switch (kind) {
+            case Kind::RECORD:
+                layout.addField(name, record());
+                break;
+            case Kind::ARRAY: {
+                auto count{number()};
+                auto element{this->kind()};
+                text();         // an element is named after its array
+                if (element == Kind::RECORD) {
+                    layout.addField(name, record(), count);
+                } else if (element == Kind::ARRAY) {
+                    malformed();
+                } else {
+                    layout.addField(name, type(element), number(), count);
+                    if (element == Kind::BITFIELD)
+                        subfields(nullptr);
+                }
+                break;
+            }
+            default:
+                layout.addField(name, type(kind), number());
+                if (kind == Kind::BITFIELD)
+                    subfields(layout.back().get());
+                break;
+            }
+        }
+        // the subfields of a BITFIELD, added to it unless it is an array element
+        void subfields(Field* bitfield) {
+            for (auto n{number()}; n > 0; --n) {
+                auto name{text()};
+                auto start{number()};
+                auto end{number()};
+                if (end < start || end >= 32)
+                    malformed();
+                if (bitfield != nullptr)
+                    bitfield->addSubfield(name, start, end);
+            }
+        }
+        static Record::fieldtype type(Kind kind) {
+            switch (kind) {
+            case Kind::UINT: return Record::fieldtype::UINT;
+            case Kind::SET: return Record::fieldtype::SET;
+            case Kind::BINARY: return Record::fieldtype::BINARY;
+            case Kind::STRING: return Record::fieldtype::STRING;
+            case Kind::BITFIELD: return Record::fieldtype::BITFIELD;
+            default: malformed();
+            }
+        }
+        Kind kind() {
+            auto value{static_cast<std::uint8_t>(take(1)[0])};
+            if (value > static_cast<std::uint8_t>(Kind::ARRAY))
+                malformed();
+            return static_cast<Kind>(value);
+        }
+        std::uint32_t number() {
+            std::uint32_t value;
+            std::memcpy(&value, take(sizeof value).data(), sizeof value);
+            return value;
+        }
+        std::string text() {
+            auto size{number()};
+            return std::string{take(size)};
+        }
+        std::string_view take(std::size_t n) {
+            if (n > bytes.size())
+                malformed();
+            auto part{bytes.substr(0, n)};
+            bytes.remove_prefix(n);
+            return part;
+        }
+        [[noreturn]] static void malformed() {
+            throw std::runtime_error("malformed table layout in shared memory");
+        }
+        std::string_view bytes;
+    };
+
+    SharedTables::SharedTables(const std::string& name, std::size_t slotSize) : name{name} {
+        slotSize = (slotSize + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+        if (slotSize < sizeof(Slot) || slotSize > UINT32_MAX)
+            throw std::runtime_error("shared memory slots cannot be " + std::to_string(slotSize) + " bytes");
+        size = sizeof(Header) + 2 * slotSize;
+        ::shm_unlink(name.c_str());
+        int fd{::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644)};
+        if (fd < 0)
+            throwErrno("cannot create shared memory " + name);
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            auto error{errno};
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            errno = error;
+            throwErrno("cannot size shared memory " + name);
+        }
+        segment = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        auto error{errno};
+        ::close(fd);
+        if (segment == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            errno = error;
+            throwErrno("cannot map shared memory " + name);
+        }
+        auto header{new (segment) Header{}};
+        new (slotOf(segment, 0)) Slot{};
+        new (slotOf(segment, 1)) Slot{};
+        std::memcpy(header->magic, magic, sizeof magic);
+        header->version = formatVersion;
+        header->slotSize = static_cast<std::uint32_t>(slotSize);
+    }
+
+    SharedTables::~SharedTables() {
+        ::munmap(segment, size);
+        ::shm_unlink(name.c_str());
+    }
+
+    std::uint64_t SharedTables::generation() const {
+        return static_cast<const Header*>(segment)->generation.load(std::memory_order_acquire);
+    }
+
+    void SharedTables::publish(const TableSnapshot& tables) {
+        std::vector<std::shared_ptr<const Table>> held;
+        for (auto number : tables.numbers())
+            held.push_back(tables.find(number));
+        publish(held);
+    }
+
+    void SharedTables::publish(const std::vector<std::shared_ptr<const Table>>& tables) {
+        auto header{static_cast<Header*>(segment)};
+        std::vector<std::string> layouts;
+        std::size_t needed{sizeof(Slot) + tables.size() * sizeof(Entry)};
+        for (const auto& tbl : tables) {
+            layouts.emplace_back();
+            encode(layouts.back(), *tbl);
+            // the image is padded to its layout, so that no field reads past it
+            needed += tbl->Name().size() + std::max(tbl->dataSize(), tbl->recordSize()) + layouts.back().size();
+        }
+        if (needed > header->slotSize)
+            throw std::runtime_error("the tables need " + std::to_string(needed) + " bytes of shared memory, more than the "
+                + std::to_string(header->slotSize) + " of a slot");
+
+        auto generation{header->generation.load(std::memory_order_relaxed) + 1};
+        auto slot{slotOf(segment, generation)};
+        auto sequence{slot->sequence.load(std::memory_order_relaxed)};
+        slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto base{reinterpret_cast<char*>(slot)};
+        std::uint32_t used{static_cast<std::uint32_t>(sizeof(Slot) + tables.size() * sizeof(Entry))};
+        const auto append = [&](const void* data, std::size_t n, std::size_t reserved) {
+            auto at{used};
+            std::memcpy(base + used, data, n);
+            std::memset(base + used + n, 0, reserved - n);
+            used += static_cast<std::uint32_t>(reserved);
+            return at;
+        };
+        for (std::size_t i{0}; i < tables.size(); ++i) {
+            const auto& tbl{*tables[i]};
+            const auto& layout{layouts[i]};
+            auto image{tbl.image()};
+            Entry entry{};
+            entry.number = tbl.Number();
+            entry.nameSize = static_cast<std::uint32_t>(tbl.Name().size());
+            entry.nameOffset = append(tbl.Name().data(), entry.nameSize, entry.nameSize);
+            entry.imageSize = static_cast<std::uint32_t>(image.size());
+            entry.imageOffset = append(image.data(), image.size(), std::max(image.size(), tbl.recordSize()));
+            entry.layoutSize = static_cast<std::uint32_t>(layout.size());
+            entry.layoutOffset = append(layout.data(), layout.size(), layout.size());
+            entry.bigEndian = tbl.bigEndian();
+            std::memcpy(base + sizeof(Slot) + i * sizeof(Entry), &entry, sizeof entry);
+        }
+        slot->generation = generation;
+        slot->count = static_cast<std::uint32_t>(tables.size());
+        slot->used = used;
+
+        slot->sequence.store(sequence + 2, std::memory_order_release);
+        header->generation.store(generation, std::memory_order_release);
+    }
+
+    std::optional<FieldRef> SharedTable::field(const std::string& fieldname) const {
+        if (auto fld = fields->find(fieldname))
+            return FieldRef{*fld, TableData{data.data(), big}};
+        return std::nullopt;
+    }
+
+    SharedTablesReader::SharedTablesReader(const std::string& name) {
+        int fd{::shm_open(name.c_str(), O_RDONLY, 0)};
+        if (fd < 0)
+            throwErrno("cannot open shared memory " + name);
+        struct stat status{};
+        if (::fstat(fd, &status) != 0) {
+            auto error{errno};
+            ::close(fd);
+            errno = error;
+            throwErrno("cannot open shared memory " + name);
+        }
+        size = static_cast<std::size_t>(status.st_size);
+        if (size < sizeof(Header)) {
+            ::close(fd);
+            throw std::runtime_error("no tables are published in " + name);
+        }
+        auto mapped{::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)};
+        auto error{errno};
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            errno = error;
+            throwErrno("cannot map shared memory " + name);
+        }
+        segment = mapped;
+        auto header{static_cast<const Header*>(segment)};
+        if (std::memcmp(header->magic, magic, sizeof magic) != 0 || header->version != formatVersion
+                || size < sizeof(Header) + 2 * std::size_t{header->slotSize}) {
+            ::munmap(mapped, size);
+            throw std::runtime_error("no tables are published in " + name);
+        }
+    }
+
+    SharedTablesReader::~SharedTablesReader() {
+        ::munmap(const_cast<void*>(segment), size);
+    }
+
+    std::uint64_t SharedTablesReader::generation() const {
+        return static_cast<const Header*>(segment)->generation.load(std::memory_order_acquire);
+    }
+
+    std::uint64_t SharedTablesReader::read(const View& view) {
+        auto header{static_cast<const Header*>(segment)};
+        for (;;) {
+            auto generation{header->generation.load(std::memory_order_acquire)};
+            if (generation == 0)
+                return 0;
+            auto slot{slotOf(segment, generation)};
+            auto sequence{slot->sequence.load(std::memory_order_acquire)};
+            if (sequence % 2 != 0) {
+                // the writer has come round to this slot again
+                std::this_thread::yield();
+                continue;
+            }
+            const auto unchanged = [&]{
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return slot->sequence.load(std::memory_order_relaxed) == sequence;
+            };
+
+            auto base{reinterpret_cast<const char*>(slot)};
+            std::vector<SharedTable> tables;
+            std::uint64_t published{0};
+            try {
+                published = slot->generation;
+                std::size_t used{slot->used};
+                std::size_t count{slot->count};
+                if (used > header->slotSize || count > (used - std::min(used, sizeof(Slot))) / sizeof(Entry))
+                    throw std::runtime_error("malformed table directory in shared memory");
+                tables.reserve(count);
+                for (std::size_t i{0}; i < count; ++i) {
+                    Entry entry;
+                    std::memcpy(&entry, base + sizeof(Slot) + i * sizeof(Entry), sizeof entry);
+                    if (std::size_t{entry.nameOffset} + entry.nameSize > used
+                            || std::size_t{entry.imageOffset} + entry.imageSize > used
+                            || std::size_t{entry.layoutOffset} + entry.layoutSize > used)
+                        throw std::runtime_error("malformed table directory in shared memory");
+                    std::string_view form{base + entry.layoutOffset, entry.layoutSize};
+                    auto it{layouts.find(form)};
+                    if (it == layouts.end()) {
+                        LayoutReader reader{form};
+                        auto layout{reader.record()};
+                        if (!reader.done())
+                            throw std::runtime_error("malformed table layout in shared memory");
+                        // a writer that keeps changing layouts should not grow this for ever
+                        if (layouts.size() >= 1024)
+                            layouts.clear();
+                        it = layouts.emplace(std::string{form}, layout).first;
+                    }
+                    tables.emplace_back(entry.number,
+                        std::string_view{base + entry.nameOffset, entry.nameSize},
+                        Bytes{reinterpret_cast<const uint8_t*>(base + entry.imageOffset), entry.imageSize},
+                        it->second, entry.bigEndian != 0);
+                }
+            }
+            catch (std::runtime_error&) {
+                // nonsense read from a slot being rewritten is simply read again
+                if (unchanged())
+                    throw;
+                continue;
+            }
+            if (!unchanged())
+                continue;
+            view(tables);
+            if (unchanged())
+                return published;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef SHAREDTABLES_H
+#define SHAREDTABLES_H
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "C12Tables.h"
+#include "TableSnapshot.h"
+
+namespace C12 {
+
+    /*
+     * Publishes the tables of a meter in a POSIX shared memory segment,
+     * so that other processes on the same host can read them in place
+     * rather than parse the printed output.  Each table is published as
+     * its image, as read from the meter, its byte order and its layout,
+     * from which a reader builds the same fields a Table has.
+     *
+     * The segment holds two slots.  A publication is written to the one
+     * readers were not sent to last, with a sequence count that is odd
+     * while it is being written, and then readers are sent to it.  A
+     * reader that finds the count changed after reading simply reads
+     * again, so the writer never waits for readers.
+     */
+    class SharedTables {
+    public:
+        // creates the segment, replacing any left by an earlier run; the
+        // name is as for shm_open, such as "/c12test"
+        explicit SharedTables(const std::string& name, std::size_t slotSize = 1 << 20);
+        ~SharedTables();
+        SharedTables(const SharedTables&) = delete;
+        SharedTables& operator=(const SharedTables&) = delete;
+        // makes these the tables readers see, throwing if they do not fit a slot
+        void publish(const std::vector<std::shared_ptr<const Table>>& tables);
+        void publish(const TableSnapshot& tables);
+        // publications so far
+        std::uint64_t generation() const;
+    private:
+        std::string name;
+        std::size_t size;
+        void* segment;
+    };
+
+    /* one table of a publication, its image still in shared memory */
+    class SharedTable {
+    public:
+        SharedTable(unsigned number, std::string_view name, Bytes image, std::shared_ptr<const Record> layout, bool bigEndian)
+            : number{number}, name{name}, data{image}, fields{std::move(layout)}, big{bigEndian} {}
+        unsigned Number() const { return number; }
+        std::string_view Name() const { return name; }
+        Bytes image() const { return data; }
+        // whether integers in the image are big-endian, as for the Table published
+        bool bigEndian() const { return big; }
+        const Record& layout() const { return *fields; }
+        // a view of the named field over the shared image, or nothing
+        std::optional<FieldRef> field(const std::string& fieldname) const;
+    private:
+        unsigned number;
+        std::string_view name;
+        Bytes data;
+        std::shared_ptr<const Record> fields;
+        bool big;
+    };
+
+    /*
+     * Maps a segment published by SharedTables.  The tables handed to a
+     * view refer to the segment, so they are only valid during the call
+     * and may change under it: read then calls the view again with the
+     * next publication, so a view should only look at the tables and
+     * keep what it found once read returns.
+     */
+    class SharedTablesReader {
+    public:
+        using View = std::function<void(const std::vector<SharedTable>& tables)>;
+        // throws std::system_error if there is no such segment
+        explicit SharedTablesReader(const std::string& name);
+        ~SharedTablesReader();
+        SharedTablesReader(const SharedTablesReader&) = delete;
+        SharedTablesReader& operator=(const SharedTablesReader&) = delete;
+        // calls view with a consistent publication and returns its generation, 0 if there was none yet
+        std::uint64_t read(const View& view);
+        // publications so far
+        std::uint64_t generation() const;
+    private:
+        std::size_t size;
+        const void* segment;
+        // layouts built so far, by their published form
+        std::map<std::string, std::shared_ptr<const Record>, std::less<>> layouts{};
+    };
+}
+
+#endif // SHAREDTABLES_H
@@ -0,0 +1,59 @@
+#ifndef SINGLEFLIGHT_H
+#define SINGLEFLIGHT_H
+#include <cstddef>
+#include <future>
+#include <map>
+#include <mutex>
+
+namespace C12 {
+
+    /*
+     * Collapses concurrent calls for the same key into one.  The first
+     * caller for a key runs the work and any caller arriving while it
+     * runs waits for it instead of running the work again, getting the
+     * same outcome, an exception included.  Once the work is done the
+     * next call for the key runs it afresh, so nothing is cached here.
+     */
+    template <class Key>
+    class SingleFlight {
+    public:
+        template <class Work>
+        void run(const Key& key, Work work) {
+            std::unique_lock<std::mutex> guard{lock};
+            auto it{flights.find(key)};
+            if (it != flights.end()) {
+                auto flight{it->second};
+                ++joined;
+                guard.unlock();
+                flight.get();
+                return;
+            }
+            std::promise<void> done;
+            flights.emplace(key, done.get_future().share());
+            guard.unlock();
+            try {
+                work();
+                done.set_value();
+            }
+            catch (...) {
+                done.set_exception(std::current_exception());
+            }
+            guard.lock();
+            auto flight{flights[key]};
+            flights.erase(key);
+            guard.unlock();
+            flight.get();
+        }
+        // calls that waited for another rather than running the work
+        std::size_t shared() const {
+            std::lock_guard<std::mutex> guard{lock};
+            return joined;
+        }
+    private:
+        mutable std::mutex lock{};
+        std::map<Key, std::shared_future<void>> flights{};
+        std::size_t joined = 0;
+    };
+}
+
+#endif // SINGLEFLIGHT_H
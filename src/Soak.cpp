@@ -0,0 +1,54 @@
+#include "Soak.h"
+#include <iomanip>
+
+namespace C12 {
+
+    bool SoakLimits::done(unsigned sessions, std::chrono::steady_clock::duration elapsed) const {
+        return (iterations != 0 && sessions >= iterations) || (duration.count() != 0 && elapsed >= duration);
+    }
+
+    SoakSummary summarize(const SessionStats& stats, std::chrono::steady_clock::duration elapsed) {
+        SoakSummary summary;
+        summary.sessions = stats.sessions();
+        summary.failures = stats.failures();
+        summary.reads = stats.histogram(Phase::Read).count();
+        // what crossed the link is recorded by the phases of the exchange
+        for (auto phase : {Phase::Connect, Phase::StartSession, Phase::Read, Phase::EndSession}) {
+            summary.bytes += stats.bytes(phase);
+            summary.retries += stats.retries(phase);
+        }
+        summary.seconds = std::chrono::duration<double>(elapsed).count();
+        if (summary.seconds > 0) {
+            summary.readsPerSecond = summary.reads / summary.seconds;
+            summary.bytesPerSecond = summary.bytes / summary.seconds;
+        }
+        if (summary.bytes != 0)
+            summary.retriesPerKilobyte = summary.retries * 1024.0 / summary.bytes;
+        if (summary.sessions != 0)
+            summary.failureRate = double(summary.failures) / summary.sessions;
+        const auto& latency{stats.histogram(Phase::Session)};
+        summary.p50 = latency.percentile(50);
+        summary.p95 = latency.percentile(95);
+        summary.p99 = latency.percentile(99);
+        summary.max = latency.max();
+        return summary;
+    }
+
+    std::ostream& writeSoakSummary(std::ostream& out, const SoakSummary& summary) {
+        auto flags{out.flags()};
+        auto precision{out.precision()};
+        out << std::fixed << std::setprecision(1)
+            << "Soak: " << summary.sessions << " sessions in " << summary.seconds << " s"
+            << ", failures: " << summary.failures << " (" << summary.failureRate * 100 << "%)\n"
+            << "Reads: " << summary.reads << ", " << summary.readsPerSecond << " per second"
+            << "; bytes: " << summary.bytes << ", " << summary.bytesPerSecond << " per second"
+            << std::setprecision(3) << "; retries: " << summary.retries << ", " << summary.retriesPerKilobyte << " per KB\n"
+            << "Session latency us: p50 " << summary.p50.count()
+            << ", p95 " << summary.p95.count()
+            << ", p99 " << summary.p99.count()
+            << ", max " << summary.max.count() << '\n';
+        out.flags(flags);
+        out.precision(precision);
+        return out;
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SOAK_H
+#define SOAK_H
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include "SessionStats.h"
+
+namespace C12 {
+
+    /*
+     * How long a soak run repeats the configured read: for a number of
+     * sessions, for a length of time, or until the first of the two.
+     * Zero means no limit of that kind.
+     */
+    struct SoakLimits {
+        unsigned iterations = 0;
+        std::chrono::seconds duration{0};
+        bool active() const { return iterations != 0 || duration.count() != 0; }
+        bool done(unsigned sessions, std::chrono::steady_clock::duration elapsed) const;
+    };
+
+    /* the throughput of a soak run, from the statistics it kept */
+    struct SoakSummary {
+        unsigned sessions = 0;
+        unsigned failures = 0;
+        std::size_t reads = 0;          // read requests, one per table or chunk
+        std::size_t bytes = 0;          // sent and received
+        unsigned retries = 0;           // link layer packets sent again
+        double seconds = 0;
+        double readsPerSecond = 0;
+        double bytesPerSecond = 0;
+        double retriesPerKilobyte = 0;
+        double failureRate = 0;         // failed sessions over all sessions
+        std::chrono::microseconds p50{0};
+        std::chrono::microseconds p95{0};
+        std::chrono::microseconds p99{0};
+        std::chrono::microseconds max{0};
+    };
+
+    SoakSummary summarize(const SessionStats& stats, std::chrono::steady_clock::duration elapsed);
+    std::ostream& writeSoakSummary(std::ostream& out, const SoakSummary& summary);
+}
+
+#endif // SOAK_H
@@ -0,0 +1,42 @@
+#include "Symbol.h"
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+
+namespace C12 {
+
+    // elements of an unordered_set never move, so Symbols can point at them
+    static std::unordered_set<std::string>& names() {
+        static std::unordered_set<std::string> table;
+        return table;
+    }
+
+    static std::shared_mutex& namesLock() {
+        static std::shared_mutex lock;
+        return lock;
+    }
+
+    Symbol::Symbol(const std::string& text) {
+        *this = find(text);
+        if (!*this) {
+            std::unique_lock<std::shared_mutex> lock{namesLock()};
+            this->text = &*names().insert(text).first;
+        }
+    }
+
+    Symbol Symbol::find(const std::string& text) {
+        std::shared_lock<std::shared_mutex> lock{namesLock()};
+        auto it{names().find(text)};
+        return it == names().end() ? Symbol{} : Symbol{&*it};
+    }
+
+    std::size_t Symbol::count() {
+        std::shared_lock<std::shared_mutex> lock{namesLock()};
+        return names().size();
+    }
+
+    const std::string& Symbol::str() const {
+        static const std::string empty;
+        return text ? *text : empty;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace C12 {
+
+    /*
+     * An interned name.  Every distinct text is stored once in a global
+     * table for the life of the program, so a Symbol is just a pointer
+     * to it and two Symbols are equal exactly when their texts are.
+     */
+    class Symbol {
+    public:
+        Symbol() = default;
+        explicit Symbol(const std::string& text);
+        // the symbol for text if it was ever interned, or a null symbol
+        static Symbol find(const std::string& text);
+        // number of distinct names interned so far
+        static std::size_t count();
+        const std::string& str() const;
+        explicit operator bool() const { return text != nullptr; }
+        bool operator==(Symbol other) const { return text == other.text; }
+        bool operator!=(Symbol other) const { return text != other.text; }
+    private:
+        explicit Symbol(const std::string* text) : text{text} {}
+        const std::string* text = nullptr;
+    };
+}
+
+// each distinct name has one address, so that is all a hash needs
+namespace std {
+    template <>
+    struct hash<C12::Symbol> {
+        std::size_t operator()(C12::Symbol sym) const noexcept { return hash<const std::string*>{}(&sym.str()); }
+    };
+}
+
+#endif // SYMBOL_H
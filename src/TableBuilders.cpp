@@ -0,0 +1,52 @@
+#include "TableBuilders.h"
+#include <stdexcept>
+#if C12_PLUGINS
+#include <dlfcn.h>
+#endif
+
+namespace C12 {
+
+    void BuilderRegistry::add(unsigned number, TableBuilder builder) {
+        if (number >= standardTables)
+            throw std::out_of_range("standard table number " + std::to_string(number) + " is out of range");
+        standard[number] = std::move(builder);
+    }
+
+    void BuilderRegistry::add(const std::string& manufacturer, const std::string& model, unsigned number, TableBuilder builder) {
+        if (number < standardTables)
+            throw std::out_of_range("manufacturer table number " + std::to_string(number) + " is below " + std::to_string(standardTables));
+        this->manufacturer[{manufacturer, model}][number] = std::move(builder);
+    }
+
+    const BuilderSet* BuilderRegistry::select(const std::string& manufacturer, const std::string& model) const {
+        auto it{this->manufacturer.find({manufacturer, model})};
+        if (it == this->manufacturer.end())
+            it = this->manufacturer.find({manufacturer, ""});
+        return it == this->manufacturer.end() ? nullptr : &it->second;
+    }
+
+    const TableBuilder* BuilderRegistry::find(unsigned number, const BuilderSet* manufacturerSet) const {
+        if (number < standardTables)
+            return standard[number] ? &standard[number] : nullptr;
+        if (manufacturerSet == nullptr)
+            return nullptr;
+        auto it{manufacturerSet->find(number)};
+        return it == manufacturerSet->end() ? nullptr : &it->second;
+    }
+
+    void BuilderRegistry::loadPlugin(const std::string& fileName) {
+#if C12_PLUGINS
+        // never closed, since the builders it registered live in it
+        auto handle{dlopen(fileName.c_str(), RTLD_NOW | RTLD_LOCAL)};
+        if (handle == nullptr)
+            throw std::runtime_error(dlerror());
+        using RegisterFunction = void (*)(BuilderRegistry&);
+        auto registerTables{reinterpret_cast<RegisterFunction>(dlsym(handle, "c12RegisterTables"))};
+        if (registerTables == nullptr)
+            throw std::runtime_error(fileName + " has no c12RegisterTables function");
+        registerTables(*this);
+#else
+        throw std::runtime_error("cannot load " + fileName + ": plugins are not supported on this platform");
+#endif
+    }
+}
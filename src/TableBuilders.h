@@ -0,0 +1,55 @@
+#ifndef TABLEBUILDERS_H
+#define TABLEBUILDERS_H
+#include <array>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "C12Tables.h"
+
+class Meter;
+
+namespace C12 {
+
+    // lays out one table over the data read from a meter
+    using TableBuilder = std::function<Table(std::string tbldata, Meter& meter)>;
+    // the builders of one manufacturer's tables, by item number from 2048
+    using BuilderSet = std::unordered_map<unsigned, TableBuilder>;
+
+    /*
+     * Maps table numbers to builders.  Standard tables have one builder
+     * each.  Manufacturer tables come in sets, each registered for an
+     * ST1 MANUFACTURER and optionally an ED_MODEL, so that the tables
+     * of several makes of meter can be loaded at once.
+     *
+     * A registry is filled before any meter is read and only read
+     * afterwards, so it needs no locking.
+     */
+    class BuilderRegistry {
+    public:
+        static constexpr unsigned standardTables{2048};
+        // throws std::out_of_range for a manufacturer table number
+        void add(unsigned number, TableBuilder builder);
+        // number counts from 2048; an empty model matches any model
+        void add(const std::string& manufacturer, const std::string& model, unsigned number, TableBuilder builder);
+        // the set for a meter, trying its model before any model, or nullptr
+        const BuilderSet* select(const std::string& manufacturer, const std::string& model) const;
+        // the builder of a table, or nullptr if there is none
+        const TableBuilder* find(unsigned number, const BuilderSet* manufacturerSet) const;
+        /*
+         * Loads a shared object and calls its registration function,
+         *
+         *     extern "C" void c12RegisterTables(C12::BuilderRegistry&);
+         *
+         * which adds whatever builders it provides.  Throws
+         * std::runtime_error if that fails or plugins are unsupported.
+         */
+        void loadPlugin(const std::string& fileName);
+    private:
+        std::array<TableBuilder, standardTables> standard{};
+        std::map<std::pair<std::string, std::string>, BuilderSet> manufacturer{};
+    };
+}
+
+#endif // TABLEBUILDERS_H
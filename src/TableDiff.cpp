@@ -0,0 +1,158 @@
+#include "TableDiff.h"
+#include <algorithm>
+#include <cstring>
+#include <typeinfo>
+
+namespace C12 {
+
+    // large enough to amortize the call, small enough to find the changes in quickly
+    static constexpr std::size_t blockSize{64};
+
+    std::vector<ByteRange> changedBytes(Bytes before, Bytes after) {
+        std::vector<ByteRange> ranges;
+        auto common{std::min(before.size(), after.size())};
+        std::size_t i{0};
+        while (i < common) {
+            auto n{std::min(blockSize, common - i)};
+            if (std::memcmp(before.data() + i, after.data() + i, n) == 0) {
+                i += n;
+                continue;
+            }
+            // a run of changes may carry on past the end of the block
+            for (auto end{i + n}; i < end; ) {
+                if (before[i] == after[i]) {
+                    ++i;
+                    continue;
+                }
+                auto start{i};
+                while (i < common && before[i] != after[i])
+                    ++i;
+                ranges.push_back(ByteRange{start, i - start});
+            }
+        }
+        auto longer{std::max(before.size(), after.size())};
+        if (longer > common) {
+            if (!ranges.empty() && ranges.back().offset + ranges.back().size == common)
+                ranges.back().size += longer - common;
+            else
+                ranges.push_back(ByteRange{common, longer - common});
+        }
+        return ranges;
+    }
+
+    static bool sameShape(const Field& before, const Field& after) {
+        if (typeid(before) != typeid(after) || before.symbol() != after.symbol() || before.size() != after.size())
+            return false;
+        if (auto array = dynamic_cast<const ARRAY*>(&before)) {
+            auto other{static_cast<const ARRAY*>(&after)};
+            return array->Count() == other->Count() && sameShape(array->Element(), other->Element());
+        }
+        if (auto record = dynamic_cast<const RECORD*>(&before))
+            return sameLayout(*record->Layout(), *static_cast<const RECORD*>(&after)->Layout());
+        return true;
+    }
+
+    bool sameLayout(const Record& before, const Record& after) {
+        if (before.size() != after.size() || before.recordSize() != after.recordSize())
+            return false;
+        return std::equal(before.begin(), before.end(), after.begin(),
+            [](const auto& a, const auto& b) { return sameShape(*a, *b); });
+    }
+
+    // true if any of the ranges, which are in order, overlaps offset to offset + size
+    static bool touched(const std::vector<ByteRange>& ranges, std::size_t offset, std::size_t size) {
+        auto it{std::upper_bound(ranges.begin(), ranges.end(), offset,
+            [](std::size_t at, const ByteRange& range) { return at < range.offset + range.size; })};
+        return it != ranges.end() && it->offset < offset + size;
+    }
+
+    static void collect(const Record& layout, TableData tabledata, std::size_t base, const std::string& prefix,
+        const std::vector<ByteRange>& ranges, std::vector<FieldChange>& changes);
+
+    /*
+     * A field at offset in the table data whose own offset is from base,
+     * which is the start of the record or array element holding it.
+     */
+    static void collect(const Field& fld, TableData tabledata, std::size_t base, std::size_t offset, const std::string& path,
+        const std::vector<ByteRange>& ranges, std::vector<FieldChange>& changes) {
+        if (!touched(ranges, offset, fld.size()))
+            return;
+        if (auto record = dynamic_cast<const RECORD*>(&fld)) {
+            collect(*record->Layout(), tabledata, offset, path + '.', ranges, changes);
+        } else if (auto array = dynamic_cast<const ARRAY*>(&fld)) {
+            const auto& element{array->Element()};
+            for (std::size_t i{0}; i < array->Count(); ++i) {
+                auto at{offset + i * element.size()};
+                collect(element, tabledata, at, at, path + '[' + std::to_string(i) + ']', ranges, changes);
+            }
+        } else {
+            changes.push_back(FieldChange{path, FieldRef{fld, tabledata + base}});
+        }
+    }
+
+    // fields are laid out one after another from the start of their record
+    static void collect(const Record& layout, TableData tabledata, std::size_t base, const std::string& prefix,
+        const std::vector<ByteRange>& ranges, std::vector<FieldChange>& changes) {
+        auto offset{base};
+        for (const auto& fld : layout) {
+            collect(*fld, tabledata, base, offset, prefix + fld->Name(), ranges, changes);
+            offset += fld->size();
+        }
+    }
+
+    std::vector<FieldChange> changedFields(const Record& layout, TableData tabledata, const std::vector<ByteRange>& ranges) {
+        std::vector<FieldChange> changes;
+        if (!ranges.empty())
+            collect(layout, tabledata, 0, "", ranges, changes);
+        return changes;
+    }
+
+    std::vector<FieldChange> changedFields(const Table& before, const Table& after) {
+        return changedFields(after, TableData{after.image().data(), after.bigEndian()}, changedBytes(before.image(), after.image()));
+    }
+
+    // the parts of the ranges from offset on
+    static std::vector<ByteRange> from(std::size_t offset, const std::vector<ByteRange>& ranges) {
+        std::vector<ByteRange> result;
+        for (const auto& range : ranges) {
+            auto end{range.offset + range.size};
+            if (end > offset) {
+                auto start{std::max(range.offset, offset)};
+                result.push_back(ByteRange{start, end - start});
+            }
+        }
+        return result;
+    }
+
+    std::ostream& printChanges(const Table& before, const Table& after, std::ostream& out) {
+        if (after.recordSize() > after.dataSize() || before.recordSize() > before.dataSize()
+                || before.bigEndian() != after.bigEndian() || !sameLayout(before, after))
+            return after.printTo(out);
+        auto ranges{changedBytes(before.image(), after.image())};
+        auto changes{changedFields(after, TableData{after.image().data(), after.bigEndian()}, ranges)};
+        // no field shows the bytes past the layout, so they are shown as they are
+        auto unmapped{from(after.recordSize(), ranges)};
+        out << "TABLE " << after.Number() << ' ' << after.Name();
+        if (changes.empty() && unmapped.empty())
+            return out << " unchanged\n";
+        out << " changed";
+        for (const auto& change : changes) {
+            out << "\n    " << change.path << " = ";
+            change.field.printTo(out);
+        }
+        auto image{after.image()};
+        for (const auto& range : unmapped) {
+            out << "\n    BYTES " << range.offset << '-' << range.offset + range.size - 1;
+            if (range.offset >= image.size()) {
+                out << " removed";
+                continue;
+            }
+            static const char digits[]{"0123456789ABCDEF"};
+            out << " =";
+            // a run may go on past a table that got shorter
+            for (auto i{range.offset}; i < std::min(range.offset + range.size, image.size()); ++i)
+                out << ' ' << digits[image[i] >> 4] << digits[image[i] & 0xf];
+        }
+        return out << '\n';
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef TABLEDIFF_H
+#define TABLEDIFF_H
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "C12Tables.h"
+
+namespace C12 {
+
+    /* bytes offset to offset + size of a table image */
+    struct ByteRange {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    /* a field that changed, by its path in the table such as TOT_DATA_BLOCK.SUMMATIONS[2], with its new value */
+    struct FieldChange {
+        std::string path;
+        FieldRef field;
+    };
+
+    /*
+     * The runs of bytes in which after differs from before, in order.
+     * Bytes past the end of the shorter image count as changed.  Equal
+     * stretches are skipped a block at a time with memcmp, which the C
+     * library does with the widest loads the processor has, so telling
+     * that a table is unchanged costs little more than reading it.
+     */
+    std::vector<ByteRange> changedBytes(Bytes before, Bytes after);
+
+    // true if both tables are laid out alike, so that a change of bytes is a change of the same field in each
+    bool sameLayout(const Record& before, const Record& after);
+
+    // the innermost fields of a layout over tabledata that overlap any of the ranges
+    std::vector<FieldChange> changedFields(const Record& layout, TableData tabledata, const std::vector<ByteRange>& ranges);
+
+    // the fields of after that differ from before, which must be laid out alike
+    std::vector<FieldChange> changedFields(const Table& before, const Table& after);
+
+    /*
+     * Prints after as only the fields that changed since before, or as a
+     * whole with Table::printTo if the two are laid out differently or
+     * in a different byte order, or the layout does not fit what was read.
+     * Changed bytes past the end of the layout are printed as BYTES with
+     * their offsets and new values in hex, or as removed.
+     */
+    std::ostream& printChanges(const Table& before, const Table& after, std::ostream& out);
+}
+
+#endif // TABLEDIFF_H
@@ -0,0 +1,151 @@
+#include "TableRegistry.h"
+#include <stdexcept>
+#include <string>
+
+namespace C12 {
+
+    TableRegistry::TableRegistry(std::size_t maxBytes)
+        : limit{maxBytes}
+    {
+    }
+
+    TableRegistry::~TableRegistry() {
+        for (auto& page : pages)
+            delete page.load();
+    }
+
+    TableRegistry::Slot* TableRegistry::slot(unsigned number) const {
+        if (number >= slots)
+            return nullptr;
+        auto page{pages[number / pageSize].load(std::memory_order_acquire)};
+        return page ? &(*page)[number % pageSize] : nullptr;
+    }
+
+    std::shared_ptr<const Table> TableRegistry::store(Table&& tbl) {
+        auto number{tbl.Number()};
+        if (number >= slots)
+            throw std::out_of_range("table number " + std::to_string(number) + " is out of range");
+        auto entry{std::make_shared<const Table>(std::move(tbl))};
+        std::lock_guard<std::mutex> lock{writeLock};
+        auto& page{pages[number / pageSize]};
+        if (!page.load(std::memory_order_relaxed))
+            page.store(new Page{}, std::memory_order_release);
+        auto& s{*slot(number)};
+        auto old{std::atomic_exchange(&s.table, entry)};
+        s.used = ++clock;
+        if (old) {
+            held -= old->dataSize();
+            if (old->symbol() != entry->symbol()) {
+                std::unique_lock<std::shared_mutex> names{nameLock};
+                byName.erase(old->symbol());
+            }
+        } else {
+            ++count;
+        }
+        held += entry->dataSize();
+        {
+            std::unique_lock<std::shared_mutex> names{nameLock};
+            byName[entry->symbol()] = number;
+        }
+        if (limit)
+            evict(number);
+        return entry;
+    }
+
+    std::shared_ptr<const Table> TableRegistry::find(unsigned number) const {
+        auto s{slot(number)};
+        if (s == nullptr)
+            return nullptr;
+        auto tbl{std::atomic_load(&s->table)};
+        if (tbl)
+            s->used = ++clock;
+        return tbl;
+    }
+
+    std::shared_ptr<const Table> TableRegistry::find(Symbol name) const {
+        unsigned number;
+        {
+            std::shared_lock<std::shared_mutex> names{nameLock};
+            auto it{byName.find(name)};
+            if (it == byName.end())
+                return nullptr;
+            number = it->second;
+        }
+        return find(number);
+    }
+
+    // with the write lock held
+    void TableRegistry::drop(Slot& s) {
+        auto old{std::atomic_exchange(&s.table, std::shared_ptr<const Table>{})};
+        if (!old)
+            return;
+        held -= old->dataSize();
+        --count;
+        std::unique_lock<std::shared_mutex> names{nameLock};
+        auto it{byName.find(old->symbol())};
+        if (it != byName.end() && it->second == old->Number())
+            byName.erase(it);
+    }
+
+    void TableRegistry::erase(unsigned number) {
+        std::lock_guard<std::mutex> lock{writeLock};
+        if (auto s = slot(number))
+            drop(*s);
+    }
+
+    void TableRegistry::clear() {
+        std::lock_guard<std::mutex> lock{writeLock};
+        for (auto& page : pages) {
+            if (auto p = page.load()) {
+                for (auto& s : *p)
+                    drop(s);
+            }
+        }
+    }
+
+    void TableRegistry::setLimit(std::size_t maxBytes) {
+        std::lock_guard<std::mutex> lock{writeLock};
+        limit = maxBytes;
+        if (limit)
+            evict(slots);
+    }
+
+    /* 
+     * Drops the least recently used tables other than keep until the
+     * data held is within the limit.  This scans every allocated page,
+     * which is cheap next to reading even one table from a meter.
+     */
+    void TableRegistry::evict(unsigned keep) {
+        while (held > limit) {
+            Slot* oldest{nullptr};
+            for (unsigned p{0}; p < pages.size(); ++p) {
+                auto page{pages[p].load()};
+                if (!page)
+                    continue;
+                for (unsigned i{0}; i < pageSize; ++i) {
+                    auto& s{(*page)[i]};
+                    if (p * pageSize + i == keep || !s.table)
+                        continue;
+                    if (oldest == nullptr || s.used < oldest->used)
+                        oldest = &s;
+                }
+            }
+            if (oldest == nullptr)
+                return;
+            drop(*oldest);
+        }
+    }
+
+    std::vector<unsigned> TableRegistry::numbers() const {
+        std::vector<unsigned> result;
+        for (unsigned p{0}; p < pages.size(); ++p) {
+            if (auto page = pages[p].load(std::memory_order_acquire)) {
+                for (unsigned i{0}; i < pageSize; ++i) {
+                    if (std::atomic_load(&(*page)[i].table))
+                        result.push_back(p * pageSize + i);
+                }
+            }
+        }
+        return result;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef TABLEREGISTRY_H
+#define TABLEREGISTRY_H
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "C12Tables.h"
+
+namespace C12 {
+
+    /*
+     * The decoded tables of one meter, one slot per table number:
+     * standard tables 0 to 2047 and manufacturer tables from 2048.
+     * Slots are allocated a page at a time, so a meter with a few
+     * dozen tables only pays for the pages it uses.
+     *
+     * A table read again replaces the earlier one in a single atomic
+     * store.  Readers hold a shared_ptr, so a table they are looking
+     * at stays valid even if it is replaced or evicted meanwhile.
+     *
+     * With a limit on the table data held, storing a table evicts the
+     * least recently used others until the total is within it again.
+     */
+    class TableRegistry {
+    public:
+        static constexpr unsigned slots{4096};
+        // a limit of 0 keeps every table
+        explicit TableRegistry(std::size_t maxBytes = 0);
+        ~TableRegistry();
+        TableRegistry(const TableRegistry&) = delete;
+        TableRegistry& operator=(const TableRegistry&) = delete;
+        // throws std::out_of_range if the table number is not below slots
+        std::shared_ptr<const Table> store(Table&& tbl);
+        std::shared_ptr<const Table> find(unsigned number) const;
+        std::shared_ptr<const Table> find(Symbol name) const;
+        void erase(unsigned number);
+        void clear();
+        void setLimit(std::size_t maxBytes);
+        std::size_t size() const { return count; }
+        // bytes of table data held
+        std::size_t bytes() const { return held; }
+        // the numbers of the tables held, in increasing order
+        std::vector<unsigned> numbers() const;
+    private:
+        static constexpr unsigned pageSize{64};
+        struct Slot {
+            std::shared_ptr<const Table> table;
+            mutable std::atomic<std::uint64_t> used{0};
+        };
+        using Page = std::array<Slot, pageSize>;
+        Slot* slot(unsigned number) const;
+        void drop(Slot& s);
+        void evict(unsigned keep);
+
+        std::array<std::atomic<Page*>, slots / pageSize> pages{};
+        std::unordered_map<Symbol, unsigned> byName{};
+        mutable std::shared_mutex nameLock{};
+        std::mutex writeLock{};
+        mutable std::atomic<std::uint64_t> clock{0};
+        std::atomic<std::size_t> count{0};
+        std::atomic<std::size_t> held{0};
+        std::size_t limit;
+    };
+}
+
+#endif // TABLEREGISTRY_H
@@ -0,0 +1,86 @@
+#include "TableSnapshot.h"
+
+namespace C12 {
+
+    TableSnapshot::TableSnapshot(const TableRegistry& tables, std::uint64_t generation)
+        : sessions{generation}
+    {
+        for (auto number : tables.numbers()) {
+            if (auto tbl = tables.find(number)) {
+                byName[tbl->symbol()] = tbl;
+                byNumber.emplace(number, std::move(tbl));
+            }
+        }
+    }
+
+    std::shared_ptr<const Table> TableSnapshot::find(unsigned number) const {
+        auto it{byNumber.find(number)};
+        return it == byNumber.end() ? nullptr : it->second;
+    }
+
+    std::shared_ptr<const Table> TableSnapshot::find(Symbol name) const {
+        auto it{byName.find(name)};
+        return it == byName.end() ? nullptr : it->second;
+    }
+
+    std::vector<unsigned> TableSnapshot::numbers() const {
+        std::vector<unsigned> result;
+        result.reserve(byNumber.size());
+        for (const auto& entry : byNumber)
+            result.push_back(entry.first);
+        return result;
+    }
+
+    std::optional<long> TableSnapshot::evaluate(const Expression& expression) const {
+        return expression.evaluate([this](const Reference& ref) -> std::optional<long> {
+            // a table that was read but lacks the field counts as zero
+            if (auto t = find(ref.table))
+                return resolve(*t, ref);
+            return std::nullopt;
+        });
+    }
+
+    std::string TableSnapshot::evaluateAsString(const std::string& expression) const {
+        // TABLE.FIELD, then any of .MEMBER, [INDEX] and a last .SUBFIELD
+        auto dot{expression.find('.')};
+        if (dot == std::string::npos)
+            return "";
+        auto t{find(Symbol::find(expression.substr(0, dot)))};
+        if (t == nullptr)
+            return "";
+        auto pos{expression.find_first_of(".[", dot + 1)};
+        auto ref{t->field(expression.substr(dot + 1, pos - dot - 1))};
+        while (ref && pos != std::string::npos) {
+            if (expression[pos] == '[') {
+                auto close{expression.find(']', pos)};
+                auto digits{expression.substr(pos + 1, close - pos - 1)};
+                if (close == std::string::npos || digits.empty() || digits.size() > 9
+                        || digits.find_first_not_of("0123456789") != std::string::npos)
+                    return "";
+                ref = ref->element(std::stoul(digits));
+                pos = close + 1 == expression.size() ? std::string::npos : close + 1;
+                if (pos != std::string::npos && expression[pos] != '.' && expression[pos] != '[')
+                    return "";
+                continue;
+            }
+            auto next{expression.find_first_of(".[", pos + 1)};
+            auto name{expression.substr(pos + 1, next - pos - 1)};
+            if (auto member = ref->member(name)) {
+                ref = member;
+                pos = next;
+                continue;
+            }
+            // a subfield has no FieldRef of its own, so it ends the path
+            auto bits{dynamic_cast<const BITFIELD*>(&ref->field())};
+            if (bits == nullptr || next != std::string::npos)
+                return "";
+            auto sym{Symbol::find(name)};
+            for (const auto& sub : bits->Subfields()) {
+                if (sub.symbol() == sym)
+                    return std::to_string(ref->value(name));
+            }
+            return "";
+        }
+        return ref ? ref->to_string() : "";
+    }
+}
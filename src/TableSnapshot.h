@@ -0,0 +1,61 @@
+#ifndef TABLESNAPSHOT_H
+#define TABLESNAPSHOT_H
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "C12Tables.h"
+#include "Expression.h"
+#include "TableRegistry.h"
+
+namespace C12 {
+
+    /*
+     * The tables of a meter as they stood when a session completed.  A
+     * snapshot never changes once made: it holds the tables themselves,
+     * which are immutable, so a table read again later replaces it in
+     * the registry and in later snapshots but not in this one.
+     */
+    class TableSnapshot {
+    public:
+        TableSnapshot() = default;
+        // the tables the registry holds now, after the given number of sessions
+        TableSnapshot(const TableRegistry& tables, std::uint64_t generation);
+        std::shared_ptr<const Table> find(unsigned number) const;
+        std::shared_ptr<const Table> find(Symbol name) const;
+        std::size_t size() const { return byNumber.size(); }
+        // the numbers of the tables held, in increasing order
+        std::vector<unsigned> numbers() const;
+        // sessions completed when the snapshot was made, 0 before the first
+        std::uint64_t generation() const { return sessions; }
+        // the value of an expression over these tables, or nothing if it refers to one that is missing
+        std::optional<long> evaluate(const Expression& expression) const;
+        // the value of TABLE.FIELD as text, where the field may be followed by
+        // .MEMBER of a record, [INDEX] of an array or .SUBFIELD of a bitfield,
+        // or empty if there is no such field
+        std::string evaluateAsString(const std::string& expression) const;
+    private:
+        std::map<unsigned, std::shared_ptr<const Table>> byNumber{};
+        std::unordered_map<Symbol, std::shared_ptr<const Table>> byName{};
+        std::uint64_t sessions = 0;
+    };
+
+    /*
+     * The latest snapshot.  The writer replaces it in one atomic store
+     * and a reader takes a reference to whichever is current, which it
+     * may keep as long as it likes, so readers never wait for a session
+     * in progress and never see part of one.
+     */
+    class SnapshotCell {
+    public:
+        std::shared_ptr<const TableSnapshot> load() const { return std::atomic_load(&current); }
+        void store(std::shared_ptr<const TableSnapshot> next) { std::atomic_store(&current, std::move(next)); }
+    private:
+        std::shared_ptr<const TableSnapshot> current{std::make_shared<const TableSnapshot>()};
+    };
+}
+
+#endif // TABLESNAPSHOT_H
@@ -0,0 +1,414 @@
+#include "Tdl.h"
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace C12 {
+
+    struct TdlMember;
+
+    /* a type as declared, with the dimensions that are only known per meter left as expressions */
+    struct TdlType {
+        enum class Kind { Uint, String, Binary, Set, BitField, Record } kind;
+        std::string name{};
+        std::size_t size = 0;                   // of a Uint or BitField
+        std::optional<Expression> dim{};        // of a String, Binary or Set
+        std::vector<std::tuple<std::string, unsigned, unsigned>> subfields{};
+        std::vector<TdlMember> members{};
+    };
+
+    /* a field of a record, or an IF section when it has a condition */
+    struct TdlMember {
+        std::string name{};
+        std::shared_ptr<const TdlType> type{};
+        std::optional<Expression> count{};
+        std::optional<Expression> condition{};
+        std::vector<TdlMember> then{};
+        std::vector<TdlMember> otherwise{};
+    };
+
+    using Evaluate = std::function<long(const Expression&)>;
+
+    static void addMembers(Record& rec, const std::vector<TdlMember>& members, const Evaluate& eval);
+
+    static void addMember(Record& rec, const TdlMember& m, const Evaluate& eval) {
+        const auto& type{*m.type};
+        if (type.kind == TdlType::Kind::Record) {
+            auto layout{std::make_shared<Record>(type.name)};
+            addMembers(*layout, type.members, eval);
+            if (m.count)
+                rec.addField(m.name, layout, eval(*m.count));
+            else
+                rec.addField(m.name, layout);
+            return;
+        }
+        Record::fieldtype fieldtype{Record::fieldtype::UINT};
+        std::size_t size{type.size};
+        switch (type.kind) {
+        case TdlType::Kind::String: fieldtype = Record::fieldtype::STRING; break;
+        case TdlType::Kind::Binary: fieldtype = Record::fieldtype::BINARY; break;
+        case TdlType::Kind::Set: fieldtype = Record::fieldtype::SET; break;
+        case TdlType::Kind::BitField: fieldtype = Record::fieldtype::BITFIELD; break;
+        default: break;
+        }
+        if (type.dim)
+            size = eval(*type.dim);
+        if (m.count)
+            rec.addField(m.name, fieldtype, size, eval(*m.count));
+        else
+            rec.addField(m.name, fieldtype, size);
+        for (const auto& [subname, start, end] : type.subfields)
+            rec.addSubfield(m.name, subname, start, end);
+    }
+
+    static void addMembers(Record& rec, const std::vector<TdlMember>& members, const Evaluate& eval) {
+        for (const auto& m : members) {
+            if (m.condition)
+                addMembers(rec, eval(*m.condition) ? m.then : m.otherwise, eval);
+            else
+                addMember(rec, m, eval);
+        }
+    }
+
+    TdlTable::TdlTable(unsigned number, std::string name, std::string manufacturer, std::string model, std::shared_ptr<const TdlType> record)
+        : num{number}
+        , name{std::move(name)}
+        , mfg{std::move(manufacturer)}
+        , mdl{std::move(model)}
+        , record{std::move(record)}
+    {
+    }
+
+    Table TdlTable::build(const std::string& tbldata, const Expression::Resolver& resolve, bool bigEndian) const {
+        Table tbl{num, name, record->name, tbldata};
+        // before any field of it is looked at, as a dimension or condition may do
+        tbl.setDataOrder(bigEndian);
+        // fields laid out so far in this table are found in it, other tables through resolve
+        const auto self = [&tbl, &resolve](const Reference& ref) -> std::optional<long> {
+            if (ref.table == tbl.symbol())
+                return C12::resolve(tbl, ref);
+            return resolve(ref);
+        };
+        // a dimension or condition needing a table that was not read is 0
+        const Evaluate eval = [&self](const Expression& expr) { return expr.evaluate(self).value_or(0); };
+        addMembers(tbl, record->members, eval);
+        return tbl;
+    }
+
+    /* reads the document syntax a word or symbol at a time */
+    class TdlReader {
+    public:
+        explicit TdlReader(std::istream& in) {
+            std::ostringstream ss;
+            ss << in.rdbuf();
+            text = ss.str();
+        }
+
+        std::vector<TdlTable> read() {
+            std::vector<TdlTable> tables;
+            while (skip(), pos < text.size()) {
+                if (keyword("MANUFACTURER")) {
+                    manufacturer = quoted();
+                    model = keyword("MODEL") ? quoted() : "";
+                    expect(';');
+                } else if (keyword("TYPE")) {
+                    auto name{word()};
+                    expect('=');
+                    types[name] = declaration(name);
+                    expect(';');
+                } else {
+                    bool mfgTable{keyword("MFG")};
+                    if (!keyword("TABLE"))
+                        fail("MANUFACTURER, TYPE or TABLE expected");
+                    auto number{static_cast<unsigned>(this->number())};
+                    if (number >= 2048)
+                        fail("table number " + std::to_string(number) + " is too large");
+                    auto name{word()};
+                    expect('=');
+                    auto record{lookup(word())};
+                    if (record->kind != TdlType::Kind::Record)
+                        fail("a table must be a PACKED RECORD");
+                    expect(';');
+                    if (mfgTable)
+                        tables.emplace_back(number + 2048, name, manufacturer, model, record);
+                    else
+                        tables.emplace_back(number, name, "", "", record);
+                }
+            }
+            return tables;
+        }
+
+    private:
+        [[noreturn]] void fail(const std::string& what) const {
+            throw std::runtime_error("line " + std::to_string(line) + ": " + what);
+        }
+
+        void advance() {
+            if (text[pos++] == '\n')
+                ++line;
+        }
+
+        // blanks and comments
+        void skip() {
+            while (pos < text.size()) {
+                if (std::isspace(static_cast<unsigned char>(text[pos]))) {
+                    advance();
+                } else if (text.compare(pos, 2, "//") == 0) {
+                    while (pos < text.size() && text[pos] != '\n')
+                        advance();
+                } else if (text[pos] == '{') {
+                    while (pos < text.size() && text[pos] != '}')
+                        advance();
+                    if (pos == text.size())
+                        fail("comment is not closed");
+                    advance();
+                } else {
+                    return;
+                }
+            }
+        }
+
+        static bool isWordChar(char ch) {
+            return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_';
+        }
+
+        std::string peekWord() {
+            skip();
+            auto end{pos};
+            while (end < text.size() && isWordChar(text[end]))
+                ++end;
+            return text.substr(pos, end - pos);
+        }
+
+        std::string word() {
+            auto w{peekWord()};
+            if (w.empty() || std::isdigit(static_cast<unsigned char>(w[0])))
+                fail("name expected");
+            pos += w.size();
+            return w;
+        }
+
+        bool keyword(const std::string& kw) {
+            if (peekWord() != kw)
+                return false;
+            pos += kw.size();
+            return true;
+        }
+
+        void expect(char ch) {
+            skip();
+            if (pos >= text.size() || text[pos] != ch)
+                fail(std::string{"'"} + ch + "' expected");
+            advance();
+        }
+
+        bool accept(char ch) {
+            skip();
+            if (pos >= text.size() || text[pos] != ch)
+                return false;
+            advance();
+            return true;
+        }
+
+        unsigned long number() {
+            auto w{peekWord()};
+            if (w.empty() || w.find_first_not_of("0123456789") != std::string::npos)
+                fail("number expected");
+            pos += w.size();
+            return std::stoul(w);
+        }
+
+        std::string quoted() {
+            expect('"');
+            auto end{text.find('"', pos)};
+            if (end == std::string::npos)
+                fail("closing '\"' expected");
+            auto str{text.substr(pos, end - pos)};
+            while (pos <= end)
+                advance();
+            return str;
+        }
+
+        // the text up to a closing bracket, or the word THEN, as an expression
+        Expression expression(const std::string& until) {
+            skip();
+            auto start{pos};
+            int depth{0};
+            while (pos < text.size()) {
+                if (until == "THEN" && depth == 0 && peekWord() == "THEN")
+                    break;
+                if (pos >= text.size())
+                    break;
+                auto ch{text[pos]};
+                if (depth == 0 && until.size() == 1 && ch == until[0])
+                    break;
+                if (ch == '(' || ch == '[')
+                    ++depth;
+                else if (ch == ')' || ch == ']')
+                    --depth;
+                if (isWordChar(ch)) {
+                    while (pos < text.size() && isWordChar(text[pos]))
+                        advance();
+                } else {
+                    advance();
+                }
+            }
+            if (pos >= text.size())
+                fail("'" + until + "' expected");
+            try {
+                return Expression{text.substr(start, pos - start)};
+            }
+            catch (std::invalid_argument& ex) {
+                fail(ex.what());
+            }
+        }
+
+        std::shared_ptr<const TdlType> lookup(const std::string& name) {
+            auto it{types.find(name)};
+            if (it == types.end())
+                fail("unknown type " + name);
+            return it->second;
+        }
+
+        static std::size_t uintSize(const std::string& name) {
+            static const std::map<std::string, std::size_t> sizes{
+                {"UINT8", 1}, {"UINT16", 2}, {"UINT24", 3}, {"UINT32", 4},
+                {"INT8", 1}, {"INT16", 2}, {"INT24", 3}, {"INT32", 4},
+            };
+            auto it{sizes.find(name)};
+            return it == sizes.end() ? 0 : it->second;
+        }
+
+        // a type named where a field is declared
+        std::shared_ptr<const TdlType> typeReference() {
+            auto name{word()};
+            if (auto size = uintSize(name)) {
+                auto type{std::make_shared<TdlType>(TdlType{TdlType::Kind::Uint})};
+                type->size = size;
+                return type;
+            }
+            static const std::map<std::string, TdlType::Kind> sized{
+                {"STRING", TdlType::Kind::String}, {"CHAR", TdlType::Kind::String},
+                {"BINARY", TdlType::Kind::Binary}, {"FILL", TdlType::Kind::Binary},
+                {"SET", TdlType::Kind::Set},
+            };
+            auto it{sized.find(name)};
+            if (it == sized.end())
+                return lookup(name);
+            expect('(');
+            auto type{std::make_shared<TdlType>(TdlType{it->second})};
+            type->dim = expression(")");
+            expect(')');
+            return type;
+        }
+
+        std::shared_ptr<const TdlType> declaration(const std::string& name) {
+            if (keyword("BIT")) {
+                if (!keyword("FIELD") || !keyword("OF"))
+                    fail("BIT FIELD OF expected");
+                auto type{std::make_shared<TdlType>(TdlType{TdlType::Kind::BitField, name})};
+                type->size = uintSize(word());
+                if (type->size == 0)
+                    fail("a BIT FIELD must be OF UINT8, UINT16, UINT24 or UINT32");
+                while (!keyword("END"))
+                    subfield(*type);
+                return type;
+            }
+            if (keyword("PACKED") && keyword("RECORD")) {
+                auto type{std::make_shared<TdlType>(TdlType{TdlType::Kind::Record, name})};
+                type->members = members();
+                if (!keyword("END"))
+                    fail("END expected");
+                return type;
+            }
+            fail("BIT FIELD or PACKED RECORD expected");
+        }
+
+        void subfield(TdlType& type) {
+            bool fill{keyword("FILL")};
+            std::string name;
+            if (!fill) {
+                name = word();
+                expect(':');
+                fill = keyword("FILL");
+            }
+            bool single{!fill && keyword("BOOL")};
+            if (!fill && !single && !keyword("UINT"))
+                fail("UINT, BOOL or FILL expected");
+            expect('(');
+            auto start{static_cast<unsigned>(number())};
+            auto end{start};
+            if (!single) {
+                expect('.');
+                expect('.');
+                end = static_cast<unsigned>(number());
+            }
+            expect(')');
+            expect(';');
+            if (end < start || end >= type.size * 8)
+                fail("bits " + std::to_string(start) + ".." + std::to_string(end) + " do not fit");
+            if (!fill)
+                type.subfields.emplace_back(name, start, end);
+        }
+
+        // fields up to an END or ELSE, which is left to be read
+        std::vector<TdlMember> members() {
+            std::vector<TdlMember> list;
+            for (;;) {
+                auto w{peekWord()};
+                if (w == "END" || w == "ELSE" || pos >= text.size())
+                    return list;
+                TdlMember m;
+                if (keyword("IF")) {
+                    m.condition = expression("THEN");
+                    keyword("THEN");
+                    m.then = members();
+                    if (keyword("ELSE"))
+                        m.otherwise = members();
+                    if (!keyword("END"))
+                        fail("END expected");
+                } else {
+                    m.name = word();
+                    expect(':');
+                    if (keyword("ARRAY")) {
+                        expect('[');
+                        m.count = expression("]");
+                        expect(']');
+                        if (!keyword("OF"))
+                            fail("OF expected");
+                    }
+                    m.type = typeReference();
+                }
+                expect(';');
+                list.push_back(std::move(m));
+            }
+        }
+
+        std::string text{};
+        std::size_t pos = 0;
+        unsigned line = 1;
+        std::string manufacturer{};
+        std::string model{};
+        std::map<std::string, std::shared_ptr<const TdlType>> types{};
+    };
+
+    std::vector<TdlTable> readTdl(std::istream& in) {
+        return TdlReader{in}.read();
+    }
+
+    std::vector<TdlTable> readTdl(const std::string& fileName) {
+        std::ifstream in{fileName};
+        if (!in)
+            throw std::runtime_error("cannot open " + fileName);
+        try {
+            return readTdl(in);
+        }
+        catch (std::runtime_error& ex) {
+            throw std::runtime_error(fileName + ", " + ex.what());
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef TDL_H
+#define TDL_H
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "C12Tables.h"
+#include "Expression.h"
+
+namespace C12 {
+
+    struct TdlType;
+
+    /*
+     * A table layout read from the document syntax of the standard,
+     * as in the comment at the end of C12Tables.h.  The subset read is
+     *
+     *     MANUFACTURER "EE" MODEL "KV2";       applies to the MFG TABLEs after it
+     *     TYPE name = BIT FIELD OF UINT16
+     *         sub : UINT(0..3);
+     *         flag : BOOL(4);
+     *         FILL(5..15);
+     *     END;
+     *     TYPE name = PACKED RECORD
+     *         field : UINT8;                   also UINT16, UINT24, UINT32
+     *         text : STRING(6);                also CHAR(n), BINARY(n), SET(n)
+     *         list : ARRAY[expression] OF type;
+     *         IF expression THEN
+     *             ...
+     *         ELSE
+     *             ...
+     *         END;
+     *     END;
+     *     TABLE 12 UOM_ENTRY_TBL = UOM_ENTRY_RCD;
+     *     MFG TABLE 0 MY_TBL = MY_RCD;
+     *
+     * where a type may be any BIT FIELD or PACKED RECORD declared before
+     * it and every dimension and condition is a C12::Expression.  Its
+     * references may name the table being defined.  Text from // to the
+     * end of a line and between { and } is a comment.
+     */
+    class TdlTable {
+    public:
+        TdlTable(unsigned number, std::string name, std::string manufacturer, std::string model, std::shared_ptr<const TdlType> record);
+        // item number, so 2048 and up for manufacturer tables
+        unsigned number() const { return num; }
+        const std::string& Name() const { return name; }
+        // empty for standard tables, or for manufacturer tables of any meter
+        const std::string& manufacturer() const { return mfg; }
+        const std::string& model() const { return mdl; }
+        // lays the table out over tbldata, in the meter's byte order, looking up other tables through resolve
+        Table build(const std::string& tbldata, const Expression::Resolver& resolve, bool bigEndian = false) const;
+    private:
+        unsigned num;
+        std::string name;
+        std::string mfg;
+        std::string mdl;
+        std::shared_ptr<const TdlType> record;
+    };
+
+    // throws std::runtime_error naming the line of the first error
+    std::vector<TdlTable> readTdl(std::istream& in);
+    std::vector<TdlTable> readTdl(const std::string& fileName);
+}
+
+#endif // TDL_H
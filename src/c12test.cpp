@@ -5,46 +5,531 @@
 #include "C12Tables.h"
 #include "C12Meter.h"
 #include "Setup.h"
+#include "Replay.h"
+#include "Schedule.h"
+#include "Fleet.h"
+#include "ChannelPool.h"
+#include "ReadPlan.h"
+#include "Soak.h"
+#if C12_GATEWAY
+#include "Gateway.h"
+#endif
+#if C12_SHARED_TABLES
+#include "SharedTables.h"
+#endif
 #include <algorithm>
-#include <cctype>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <sstream>
+#include <streambuf>
+#include <thread>
 
-static bool ReadMeter(Meter& meter, MProtocol* proto, std::vector<std::string> tblvec, unsigned& failures) {
+// names the items a deadline left unread, if any
+static void ReportUnread(const Meter& meter, std::ostream& out) {
+    auto items{meter.unread()};
+    if (items.empty())
+        return;
+    out << "Not read before the deadline:";
+    for (const auto& item : items)
+        out << ' ' << item;
+    out << '\n';
+}
+
+static bool ReadMeter(Meter& meter, MProtocol* proto, std::vector<std::string> tblvec, unsigned& failures, bool* refused = nullptr) {
     bool done{false};
+    bool failed{false};
+    auto start{std::chrono::steady_clock::now()};
     try {
         meter.Communicate(*proto, tblvec);
         meter.GetResults(*proto, tblvec);
+        ReportUnread(meter, std::cout);
     }
     catch(MEOperationCancelled &) {
         std::cout << "Test loop is cancelled with Ctrl-C.\n";
         done = true;
     }
+    catch(MEC12NokResponse & ex) {
+        std::cerr << "### Error: " << ex.AsString() << '\n';
+        if (refused != nullptr)
+            *refused = true;    // the caller counts it, unless a read without the plan succeeds
+        else
+            ++failures;
+        failed = true;
+    }
     catch(MException & ex) {
         std::cerr << "### Error: " << ex.AsString() << '\n';
         ++failures;
+        failed = true;
     }
     proto->Disconnect();        // never throws
+    if (auto stats = meter.statistics()) {
+        C12::PhaseSample sample;
+        sample.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        stats->record(C12::Phase::Session, "", sample);
+        stats->sessionDone(failed);
+    }
     return done;
 }
 
-/* 
- * Given a string containing table numbers such as "{ 0 1 20 21 }",
- * returns a vector containing each numeric argument, prepended 
- * with the passed prefix.  If the prefix is "ST" in this case,
- * the returned vector would be "ST0, ST1, ST20, ST21"
+/*
+ * Decodes the table reads recorded in monitor logs instead of reading
+ * a meter.  The summary line doubles as a benchmark of the decoder.
+ */
+static int ReplayLogs(const std::string& path) {
+    unsigned failures{0};
+    std::size_t tables{0};
+    auto start{std::chrono::steady_clock::now()};
+    auto results{C12::replay(C12::replayFiles(path))};
+    auto elapsed{std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)};
+    for (const auto& result : results) {
+        std::cout << "Replay of " << result.file << ":\n" << result.output;
+        if (!result.error.empty()) {
+            std::cerr << "### Error: " << result.file << ": " << result.error << '\n';
+            ++failures;
+        }
+        tables += result.tables;
+    }
+    std::cout << "Replayed " << results.size() << " logs, " << tables
+        << " tables in " << elapsed.count() << " us, errors: " << failures << '\n';
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*
+ * Writes a file next to its final name and then renames it, so that a
+ * reader polling it never sees a partial file.
+ */
+template <class Writer>
+static void WriteFile(const std::string& fileName, Writer write) {
+    auto tmpName{fileName + ".tmp"};
+    {
+        std::ofstream file{tmpName};
+        write(file);
+        if (!file) {
+            std::cerr << "### Error: cannot write " << tmpName << '\n';
+            return;
+        }
+    }
+    if (std::rename(tmpName.c_str(), fileName.c_str()) != 0)
+        std::cerr << "### Error: cannot write " << fileName << '\n';
+}
+
+static void WriteStatistics(const std::string& fileName, const C12::SessionStats& stats) {
+    WriteFile(fileName, [&stats](std::ostream& out) { stats.writeJson(out); });
+}
+
+// the tables GEN_CONFIG_TBL lists as used, as item names
+static std::vector<std::string> TablesUsed(const Meter& meter) {
+    std::vector<std::string> items;
+    for (auto number : meter.tablesUsed())
+        items.push_back(Meter::itemName(number));
+    return items;
+}
+
+/*
+ * The name a single meter's plan is kept under: the AP title it is
+ * called by over C12.22, or else the peer or port its channel reaches
+ * it at, so that runs for different meters sharing a plan file do not
+ * use each other's plans.
+ */
+static std::string PlanKey(MProtocol* proto) {
+    if (proto->IsPropertyPresent("CALLED_AP_TITLE")) {
+        auto title{proto->GetProperty("CALLED_AP_TITLE").AsString()};
+        if (!title.empty())
+            return title;
+    }
+    auto channel{proto->GetChannel()};
+    if (channel->IsPropertyPresent("PEER_ADDRESS")) {
+        auto peer{channel->GetProperty("PEER_ADDRESS").AsString()};
+        if (!peer.empty())
+            return channel->IsPropertyPresent("PEER_PORT") ? peer + ':' + channel->GetProperty("PEER_PORT").AsString() : peer;
+    }
+    if (channel->IsPropertyPresent("PORT_NAME")) {
+        auto port{channel->GetProperty("PORT_NAME").AsString()};
+        if (!port.empty())
+            return port;
+    }
+    return "meter";
+}
+
+// the items of used that are not among those already read
+static std::vector<std::string> Unread(const std::vector<std::string>& used, const std::vector<std::string>& read) {
+    std::vector<std::string> items;
+    std::copy_if(used.begin(), used.end(), std::back_inserter(items),
+        [&read](const std::string& item) { return std::find(read.begin(), read.end(), item) == read.end(); });
+    return items;
+}
+
+/*
+ * Stays resident and reads each scheduled item at its own interval,
+ * keeping the protocol, channel and meter objects between polls.
+ * Returns when Ctrl-C is pressed.
+ */
+static void Poll(const Setup& setup, Meter& meter, MProtocol* proto, const std::vector<std::string>& tables, unsigned& failures) {
+    C12::Schedule schedule;
+    for (const auto& entry : setup.GetSchedule())
+        schedule.add(entry.first, std::chrono::seconds(entry.second));
+    if (schedule.empty()) {
+        for (const auto& tbl : tables)
+            schedule.add(tbl, std::chrono::seconds(setup.GetPollInterval()));
+    }
+    if (schedule.empty()) {
+        std::cerr << "### Error: nothing to poll\n";
+        ++failures;
+        return;
+    }
+    for (unsigned polls{1}; ; ++polls) {
+        auto items{schedule.due(C12::Schedule::clock::now())};
+        if (ReadMeter(meter, proto, items, failures))
+            return;
+        std::cout << "Poll " << polls << ": " << items.size() << " items"
+            << ", errors: " << failures
+            << ", retries: " << proto->GetCountLinkLayerPacketsRetried() + meter.pipelineRetries()
+            << std::endl;
+        if (meter.statistics())
+            WriteStatistics(setup.GetStatisticsFileName(), *meter.statistics());
+        while (C12::Schedule::clock::now() < schedule.next()) {
+            if (Meter::interrupted()) {
+                std::cout << "Polling is cancelled with Ctrl-C.\n";
+                return;
+            }
+            MUtilities::Sleep(100);
+        }
+    }
+}
+
+// the configured read, in one session or with --single one per item, true if Ctrl-C ended it
+static bool ReadOnce(const Setup& setup, Meter& meter, MProtocol* proto, const std::vector<std::string>& tables, unsigned& failures) {
+    if (!setup.GetSingleFlag())
+        return ReadMeter(meter, proto, tables, failures);
+    for (const auto& tbl : tables) {
+        std::vector<std::string> tblvec{tbl};
+        if (ReadMeter(meter, proto, tblvec, failures))
+            return true;
+    }
+    return false;
+}
+
+// swallows what is written to it
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int ch) override { return traits_type::not_eof(ch); }
+};
+
+/*
+ * Repeats the configured read for --iterations sessions or --duration
+ * seconds, whichever ends first, and reports the throughput.  With
+ * --single a read is one session per item, so a run can end part way
+ * through one.  Only the first read prints its tables; later ones are decoded all the same,
+ * so that decoding is part of what is measured.  A progress line is
+ * printed every ten seconds.
  */
-static std::vector<std::string> prefixTables(const std::string &tableNumbers, const std::string& prefix) {
-    std::stringstream ss{tableNumbers};
-    std::string tbl;
-    std::vector<std::string> tables;
-    while (ss >> tbl) {
-        if (std::isdigit(tbl[0])) {
-            tables.push_back(prefix + tbl);
+static void Soak(const Setup& setup, Meter& meter, MProtocol* proto, const std::vector<std::string>& tables, unsigned& failures) {
+    C12::SoakLimits limits;
+    limits.iterations = setup.GetIterations();
+    limits.duration = std::chrono::seconds(setup.GetDuration());
+    C12::SessionStats stats;
+    auto kept{meter.statistics()};
+    meter.setStatistics(&stats);
+    NullBuffer discard;
+    std::streambuf* console{nullptr};
+    auto start{std::chrono::steady_clock::now()};
+    auto nextProgress{start + std::chrono::seconds(10)};
+    // with --single each item is a session of its own, and the limits are checked before each
+    std::vector<std::vector<std::string>> reads;
+    if (setup.GetSingleFlag() && !tables.empty()) {
+        for (const auto& tbl : tables)
+            reads.push_back({tbl});
+    } else {
+        reads.push_back(tables);
+    }
+    bool done{false};
+    for (std::size_t i{0}; !done && !limits.done(stats.sessions(), std::chrono::steady_clock::now() - start); i = (i + 1) % reads.size()) {
+        done = ReadMeter(meter, proto, reads[i], failures);
+        if (console == nullptr && i + 1 == reads.size())
+            console = std::cout.rdbuf(&discard);
+        auto now{std::chrono::steady_clock::now()};
+        if (now >= nextProgress) {
+            std::ostream progress{console};
+            progress << "Soak: " << stats.sessions() << " sessions, errors: " << stats.failures() << std::endl;
+            nextProgress = now + std::chrono::seconds(10);
         }
     }
-    return tables;
+    auto elapsed{std::chrono::steady_clock::now() - start};
+    if (console != nullptr)
+        std::cout.rdbuf(console);
+    C12::writeSoakSummary(std::cout, C12::summarize(stats, elapsed));
+    if (!setup.GetStatisticsFileName().empty())
+        WriteStatistics(setup.GetStatisticsFileName(), stats);
+    meter.setStatistics(kept);
+}
+
+#if C12_GATEWAY
+/*
+ * Answers queries from other processes on a Unix socket until Ctrl-C,
+ * reading an item again in a session of its own when it is older than
+ * a query allows.  The tables of the first read stay in the meter, so
+ * an item read alone is decoded with them.
+ */
+static void Serve(const Setup& setup, Meter& meter, MProtocol* proto, unsigned& failures) {
+    C12::Gateway gateway{
+        [&](const std::string& item) {
+            // anyone who can reach the socket may send this, so never run a procedure for them
+            if (!Meter::isTable(item))
+                throw std::runtime_error(item + " is not a table");
+            std::vector<std::string> items{item};
+            try {
+                meter.Communicate(*proto, items);
+                meter.GetResults(*proto, items);
+            }
+            catch (MException& ex) {
+                proto->Disconnect();
+                ++failures;
+                throw std::runtime_error(ex.AsString());
+            }
+            proto->Disconnect();
+        },
+        C12::snapshotQuery([&meter]{ return meter.snapshot(); })};
+    try {
+        gateway.listen(setup.GetGatewayPath());
+    }
+    catch (std::exception& ex) {
+        std::cerr << "### Error: " << ex.what() << '\n';
+        ++failures;
+        return;
+    }
+    std::cout << "Answering queries on " << setup.GetGatewayPath() << ". Press Ctrl-C to stop.\n";
+    gateway.serve(Meter::interrupted);
+    std::cout << "Gateway reads: " << gateway.reads() << ", queries sharing a read: " << gateway.shared() << '\n';
+}
+#endif
+
+struct FleetResult {
+    std::string name{};
+    std::size_t tables = 0;
+    std::chrono::milliseconds elapsed{0};
+    unsigned retries = 0;
+    std::size_t unread = 0;         // items the deadline left unread
+    std::string error{};
+};
+
+/* how every meter of a fleet is read */
+struct FleetOptions {
+    bool arena = false;
+    bool reuseConnections = false;
+    C12::PlanCache* plans = nullptr;                // set in automatic mode
+    C12::ChannelPool<MChannel>* channels = nullptr;
+    std::optional<C12::Priorities> priorities{};    // set with [priority] or --deadline
+    std::chrono::milliseconds deadline{0};
+};
+
+/*
+ * Reads one meter of a fleet over the leased channel with a protocol of
+ * its own, built from the fleet defaults and then the meter's overrides.
+ * An override goes to the channel if the channel has such a property
+ * and to the protocol otherwise.  A channel that fails is discarded.
+ */
+static void ReadFleetMeterOn(C12::ChannelPool<MChannel>::Lease& channel, const C12::Fleet& fleet, const C12::FleetMeter& fm,
+        const std::vector<std::string>& tables, const FleetOptions& options, std::ostream& out, FleetResult& result) {
+    result.tables = 0;
+    result.unread = 0;
+    std::unique_ptr<MProtocol> proto{MCOMFactory::CreateProtocol(MVariant(MVariant::VAR_OBJECT), fleet.protocol.empty()
+        ? MStdString{"TYPE=PROTOCOL_ANSI_C12_18"} : C12::propertyString(fleet.protocol))};
+    for (const auto& prop : fm.properties) {
+        if (!channel->IsPropertyPresent(prop.first))
+            proto->SetPersistentPropertyValues(prop.first + '=' + prop.second);
+    }
+    proto->SetIsChannelOwned(false);
+    proto->SetChannel(channel.get());
+    MProtocolC12 *protoC12 = M_DYNAMIC_CAST(MProtocolC12, proto.get());
+    if (protoC12 != nullptr)
+        protoC12->SetEndSessionOnApplicationLayerError(true);
+    Meter meter{out};
+    if (options.arena)
+        meter.useArena();
+    if (options.priorities)
+        meter.setPriorities(*options.priorities);
+    meter.setDeadline(options.deadline);
+    const auto reportUnread = [&]{
+        ReportUnread(meter, out);
+        result.unread += meter.unread().size();
+    };
+    try {
+        auto plans{options.plans};
+        if (plans != nullptr && fm.tables.empty()) {
+            auto first{plans->firstRead(fm.name)};
+            try {
+                meter.Communicate(*proto, first);
+                meter.GetResults(*proto, first);
+            }
+            catch (MEOperationCancelled&) {
+                throw;
+            }
+            catch (MEC12NokResponse&) {
+                // a failed link says nothing of the plan, only a refused table does
+                plans->forget(fm.name);     // the meter may no longer have a planned table
+                auto bare{plans->firstRead(fm.name)};
+                if (bare == first)
+                    throw;
+                // a stale plan costs one more session, for ST0 and ST1 alone
+                proto->Disconnect();
+                first = bare;
+                meter.Communicate(*proto, first);
+                meter.GetResults(*proto, first);
+            }
+            reportUnread();
+            auto used{TablesUsed(meter)};
+            plans->learn(fm.name, meter.model(), used);
+            auto rest{Unread(used, first)};
+            if (!rest.empty()) {
+                meter.Communicate(*proto, rest);
+                meter.GetResults(*proto, rest);
+                reportUnread();
+            }
+            result.tables = first.size() + rest.size();
+        } else {
+            meter.Communicate(*proto, tables);
+            meter.GetResults(*proto, tables);
+            reportUnread();
+            result.tables = tables.size();
+        }
+    }
+    catch (MException&) {
+        result.retries += proto->GetCountLinkLayerPacketsRetried();
+        proto->Disconnect();        // never throws
+        channel.discard();
+        throw;
+    }
+    result.retries += proto->GetCountLinkLayerPacketsRetried();
+    if (!options.reuseConnections)
+        proto->Disconnect();
+}
+
+/*
+ * Reads one meter of a fleet.  When connections are reused, the channel
+ * is one left open by an earlier meter with the same channel properties
+ * if there is one, and it is left open for the next.  A relay may have
+ * closed a connection while it was idle, so a meter that fails on a
+ * reused channel is read once more on a new one.
+ */
+static FleetResult ReadFleetMeter(const C12::Fleet& fleet, const C12::FleetMeter& fm, const std::vector<std::string>& defaultTables, const FleetOptions& options, std::ostream& out) {
+    FleetResult result;
+    result.name = fm.name;
+    auto start{std::chrono::steady_clock::now()};
+    const auto& tables{fm.tables.empty() ? defaultTables : fm.tables};
+    try {
+        const auto makeChannel = [&]{
+            std::unique_ptr<MChannel> chan{MCOMFactory::CreateChannel(fleet.channel.empty()
+                ? MStdString{"TYPE=CHANNEL_OPTICAL_PROBE"} : C12::propertyString(fleet.channel))};
+            for (const auto& prop : fm.properties) {
+                if (chan->IsPropertyPresent(prop.first))
+                    chan->SetPersistentPropertyValues(prop.first + '=' + prop.second);
+            }
+            return chan;
+        };
+        auto fresh{makeChannel()};
+        auto key{fresh->GetPersistentPropertyValues(false)};
+        auto channel{options.channels->acquire(key, [&fresh]{ return std::move(fresh); })};
+        for (bool retried{false}; ; retried = true) {
+            // printed once the meter is done, so that a retry does not print its tables twice
+            std::ostringstream text;
+            try {
+                ReadFleetMeterOn(channel, fleet, fm, tables, options, text, result);
+                out << text.str();
+                break;
+            }
+            catch (MEOperationCancelled&) {
+                out << text.str();
+                throw;
+            }
+            catch (MException&) {
+                if (retried || !channel.reused()) {
+                    out << text.str();
+                    throw;
+                }
+                channel = options.channels->create(key, makeChannel);
+            }
+        }
+    }
+    catch (MException& ex) {
+        result.error = ex.AsString();
+    }
+    result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+/*
+ * Reads every meter in a fleet file from this one process, at most
+ * --jobs of them at a time.  Each meter's tables are printed as a
+ * whole when it is done, followed by a summary line per meter.
+ */
+static int ReadFleet(const Setup& setup, C12::PlanCache& plans, const std::optional<C12::Priorities>& priorities) {
+    C12::Fleet fleet;
+    try {
+        fleet = C12::readFleet(setup.GetFleetFileName());
+    }
+    catch (std::runtime_error& ex) {
+        std::cerr << "### Error: " << ex.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    const std::vector<std::string> defaultTables{setup.GetTableNames().begin(), setup.GetTableNames().end()};
+    auto jobs{std::min<std::size_t>(setup.GetJobs(), std::max<std::size_t>(fleet.meters.size(), 1))};
+    // without reuse nothing is kept, so every meter gets a channel of its own
+    C12::ChannelPool<MChannel> channels{setup.GetReuseConnectionsFlag() ? jobs : 0};
+    FleetOptions options;
+    options.arena = setup.GetArenaFlag();
+    options.reuseConnections = setup.GetReuseConnectionsFlag();
+    options.plans = setup.GetFullAutoFlag() ? &plans : nullptr;
+    options.channels = &channels;
+    options.priorities = priorities;
+    options.deadline = std::chrono::milliseconds(setup.GetDeadline());
+    std::vector<FleetResult> results(fleet.meters.size());
+    std::mutex printing;
+    std::atomic<std::size_t> next{0};
+    const auto worker = [&]{
+        for (auto i{next++}; i < fleet.meters.size() && !Meter::interrupted(); i = next++) {
+            std::ostringstream out;
+            results[i] = ReadFleetMeter(fleet, fleet.meters[i], defaultTables, options, out);
+            std::lock_guard<std::mutex> lock{printing};
+            std::cout << "Meter " << results[i].name << ":\n" << out.str();
+        }
+    };
+    std::cout << "Reading " << fleet.meters.size() << " meters, "
+        << setup.GetJobs() << " at a time. Press Ctrl-C to interrupt.\n";
+    std::vector<std::thread> pool;
+    for (std::size_t i{1}; i < jobs; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool)
+        t.join();
+
+    unsigned failures{0};
+    for (std::size_t i{0}; i < results.size(); ++i) {
+        const auto& result{results[i]};
+        std::cout << fleet.meters[i].name << ": ";
+        if (result.name.empty())
+            std::cout << "not read";
+        else if (!result.error.empty())
+            std::cout << "failed, " << result.error;
+        else
+            std::cout << "ok, " << result.tables << " items";
+        if (result.unread != 0)
+            std::cout << ", " << result.unread << " not read before the deadline";
+        std::cout << ", " << result.elapsed.count() << " ms, retries: " << result.retries << '\n';
+        if (result.name.empty() || !result.error.empty())
+            ++failures;
+    }
+    std::cout << "Meters: " << results.size() << ", errors: " << failures;
+    if (options.reuseConnections)
+        std::cout << ", connections reused: " << channels.reused();
+    std::cout << '\n';
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
 int main(int argc, char *argv[])
@@ -54,6 +539,51 @@ int main(int argc, char *argv[])
     if (!setup.Initialize(argc, argv))
         return EXIT_FAILURE;
 
+    for (const auto& definitions : setup.GetDefinitions()) {
+        try {
+            Meter::loadDefinitions(definitions);
+        }
+        catch (std::exception& ex) {
+            std::cerr << "Cannot load table definitions: " << ex.what() << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!setup.GetReplayPath().empty())
+        return ReplayLogs(setup.GetReplayPath());
+
+    C12::PlanCache plans;
+    const auto& planFileName{setup.GetPlanFileName()};
+    if (!planFileName.empty()) {
+        try {
+            plans.read(planFileName);
+        }
+        catch (std::runtime_error& ex) {
+            std::cerr << "### Error: " << ex.what() << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+    const auto writePlans = [&]{
+        if (!planFileName.empty() && setup.GetFullAutoFlag())
+            WriteFile(planFileName, [&plans](std::ostream& out) { plans.write(out); });
+    };
+
+    // items are only ordered when there is a reason to read them one at a time
+    std::optional<C12::Priorities> priorities;
+    if (!setup.GetPriorities().empty() || setup.GetDeadline() != 0) {
+        priorities.emplace();
+        for (const auto& entry : setup.GetPriorities())
+            priorities->set(entry.first, entry.second);
+        if (setup.GetChunkedFlag() || setup.GetWindow() > 1)
+            std::cerr << "### Warning: --chunked and --window read in their own order, without priorities or a deadline\n";
+    }
+
+    if (!setup.GetFleetFileName().empty()) {
+        auto status{ReadFleet(setup, plans, priorities)};
+        writePlans();
+        return status;
+    }
+
     MProtocol *proto = setup.GetProtocol();
     M_ASSERT(proto != nullptr); // ensured by successful return from Initialize
 
@@ -62,25 +592,110 @@ int main(int argc, char *argv[])
         protoC12->SetEndSessionOnApplicationLayerError(true);   // this is the only property to override
 
     std::cout << "Entering test loop. Press Ctrl-C to interrupt.\n";
+    const bool soak{setup.GetIterations() != 0 || setup.GetDuration() != 0};
     class Meter meter;
+    // tables read again would only add to an arena
+    if (setup.GetArenaFlag() && !setup.GetDaemonFlag() && !soak && setup.GetGatewayPath().empty())
+        meter.useArena();
+    meter.setChunked(setup.GetChunkedFlag());
+    meter.setChangesOnly(setup.GetChangesFlag());
+    if (priorities)
+        meter.setPriorities(*priorities);
+    meter.setDeadline(std::chrono::milliseconds(setup.GetDeadline()));
+    if (setup.GetWindow() > 1) {
+        if (proto->IsPropertyPresent("SESSIONLESS") && proto->GetProperty("SESSIONLESS").AsBool()) {
+            // each link is a copy of the configured protocol and channel
+            auto protocolProperties{proto->GetPersistentPropertyValues(false)};
+            auto channelProperties{proto->GetChannel()->GetPersistentPropertyValues(false)};
+            auto monitor{proto->GetChannel()->GetMonitor()};
+            meter.setPipeline([=]{
+                std::unique_ptr<MProtocol> link{MCOMFactory::CreateProtocol(MVariant(MVariant::VAR_OBJECT), protocolProperties)};
+                MChannel* channel = MCOMFactory::CreateChannel(channelProperties);
+                channel->SetMonitor(monitor);
+                link->SetIsChannelOwned(true);
+                link->SetChannel(channel);
+                // not a persistent property, so not among those copied
+                MProtocolC12 *linkC12 = M_DYNAMIC_CAST(MProtocolC12, link.get());
+                if (linkC12 != nullptr)
+                    linkC12->SetEndSessionOnApplicationLayerError(true);
+                return link;
+            }, setup.GetWindow());
+        } else {
+            std::cerr << "### Warning: --window needs a sessionless C12.22 protocol, reading one table at a time\n";
+        }
+    }
+    C12::SessionStats stats;
+    if (!setup.GetStatisticsFileName().empty())
+        meter.setStatistics(&stats);
+#if C12_SHARED_TABLES
+    std::unique_ptr<C12::SharedTables> shared;
+    if (!setup.GetSharedMemoryName().empty()) {
+        try {
+            shared = std::make_unique<C12::SharedTables>(setup.GetSharedMemoryName());
+        }
+        catch (std::exception& ex) {
+            std::cerr << "### Error: " << ex.what() << '\n';
+            return EXIT_FAILURE;
+        }
+        meter.setPublisher([&shared](const C12::TableSnapshot& tables) {
+            try {
+                shared->publish(tables);
+            }
+            catch (std::runtime_error& ex) {
+                std::cerr << "### Error: tables are not published: " << ex.what() << '\n';
+            }
+        });
+    }
+#endif
     auto tables{setup.GetTableNames()};
     if (setup.GetFullAutoFlag()) {
-        if (ReadMeter(meter, proto, std::vector<std::string>{"ST0"}, failures))
+        auto meterName{PlanKey(proto)};
+        auto first{plans.firstRead(meterName)};
+        bool refused{false};
+        if (ReadMeter(meter, proto, first, failures, &refused))
             return EXIT_FAILURE;
-        tables = prefixTables(meter.evaluateAsString("GEN_CONFIG_TBL.STD_TBLS_USED"), "ST");
-        auto mt = prefixTables(meter.evaluateAsString("GEN_CONFIG_TBL.MFG_TBLS_USED"), "MT");
-        std::move(mt.begin(), mt.end(), std::back_inserter(tables));
-    }
-    if (setup.GetSingleFlag()) {
-        for (const auto& tbl : tables) {
-            std::vector<std::string> tblvec{tbl};
-            if (ReadMeter(meter, proto, tblvec, failures))
-                break;
+        if (refused) {
+            plans.forget(meterName);    // the meter may no longer have a planned table
+            // a stale plan costs one more session, for ST0 and ST1 alone
+            auto bare{plans.firstRead(meterName)};
+            if (bare == first) {
+                ++failures;
+            } else {
+                first = bare;
+                if (ReadMeter(meter, proto, first, failures))
+                    return EXIT_FAILURE;
+            }
         }
-    } else {
-        ReadMeter(meter, proto, tables, failures);
+        tables = TablesUsed(meter);
+        plans.learn(meterName, meter.model(), tables);
+        writePlans();
+        // polling and soak runs read everything, otherwise what was read with ST0 is done
+        if (!setup.GetDaemonFlag() && !soak)
+            tables = Unread(tables, first);
+    }
+    if (setup.GetDaemonFlag()) {
+        Poll(setup, meter, proto, tables, failures);
+    } else if (soak) {
+        Soak(setup, meter, proto, tables, failures);
+    } else if (!ReadOnce(setup, meter, proto, tables, failures)) {
+#if C12_GATEWAY
+        if (!setup.GetGatewayPath().empty())
+            Serve(setup, meter, proto, failures);
+#endif
     }
     std::cout << "Errors: " << failures
-        << ", retries: " << proto->GetCountLinkLayerPacketsRetried()
+        << ", retries: " << proto->GetCountLinkLayerPacketsRetried() + meter.pipelineRetries()
         << '\n';
+    if (meter.statistics() && !soak)
+        WriteStatistics(setup.GetStatisticsFileName(), stats);
+#if C12_LINK_EMULATOR
+    if (auto link = setup.GetLinkEmulator()) {
+        auto stats{link->statistics()};
+        std::cout << "Link bytes sent: " << stats.bytesToPeer
+            << ", received: " << stats.bytesFromPeer
+            << ", bits corrupted: " << stats.bitsCorrupted
+            << ", bytes dropped: " << stats.bytesDropped
+            << '\n';
+    }
+#endif
 }
@@ -0,0 +1,61 @@
+#include <sstream>
+#include <string>
+#include "Arena.h"
+#include "C12Tables.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+static const std::string data{"\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10", 16};
+
+static std::string decode() {
+    Table tbl{2048, "MY_TEST_TBL", "MY_TEST_RCD", data};
+    tbl.addField("FLAGS", Table::fieldtype::BITFIELD, 1);
+    tbl.addSubfield("FLAGS", "LOW", 0, 3);
+    tbl.addSubfield("FLAGS", "HIGH", 4, 7);
+    for (int i{1}; i < 16; ++i)
+        tbl.addField("FIELD" + std::to_string(i), Table::fieldtype::UINT, 1);
+    std::stringstream ss;
+    tbl.printTo(ss);
+    return ss.str();
+}
+
+static std::size_t allocationsFor(Arena* arena) {
+    ArenaScope scope{arena};
+    auto before{allocationCounters().allocations};
+    decode();
+    return allocationCounters().allocations - before;
+}
+
+TEST(ArenaTest, sameResult) {
+    Arena arena;
+    std::string fromHeap{decode()};
+    ArenaScope scope{&arena};
+    EXPECT_EQ(decode(), fromHeap);
+}
+
+TEST(ArenaTest, fewerAllocations) {
+    auto fromHeap{allocationsFor(nullptr)};
+    Arena arena;
+    auto fromArena{allocationsFor(&arena)};
+    // one per field at least on the heap, and only the first block of the arena
+    EXPECT_GE(fromHeap, 16u);
+    EXPECT_LE(fromArena, 1u);
+}
+
+TEST(ArenaTest, scopesNest) {
+    Arena outer, inner;
+    EXPECT_NE(tableResource(), outer.get());
+    {
+        ArenaScope a{&outer};
+        EXPECT_EQ(tableResource(), outer.get());
+        {
+            ArenaScope b{&inner};
+            EXPECT_EQ(tableResource(), inner.get());
+            ArenaScope c{nullptr};
+            EXPECT_NE(tableResource(), inner.get());
+        }
+        EXPECT_EQ(tableResource(), outer.get());
+    }
+    EXPECT_NE(tableResource(), outer.get());
+}
@@ -0,0 +1,139 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "AsyncLog.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+static std::string tempName(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("c12test-" + name + ".bin")).string();
+}
+
+static std::vector<LogRecord> readBack(const std::string& fileName) {
+    std::ifstream in{fileName, std::ios::binary};
+    EXPECT_TRUE(isBinaryLog(in));
+    return readBinaryLog(in);
+}
+
+TEST(AsyncLogTest, ringWrapsAround) {
+    ByteRing ring{64};
+    ASSERT_EQ(ring.capacity(), 64u);
+    std::string out;
+    for (int round{0}; round < 10; ++round) {
+        std::string piece(20, static_cast<char>('a' + round));
+        ASSERT_TRUE(ring.push(piece.data(), 5, piece.data() + 5, 15));
+        ASSERT_TRUE(ring.push(piece.data(), piece.size()));
+        EXPECT_FALSE(ring.push(piece.data(), 25));
+        out.clear();
+        EXPECT_EQ(ring.pop(out, 100), 40u);
+        EXPECT_EQ(out, piece + piece);
+        EXPECT_EQ(ring.space(), 64u);
+    }
+}
+
+TEST(AsyncLogTest, ringAcrossThreads) {
+    ByteRing ring{256};
+    constexpr unsigned count{20000};
+    std::thread producer([&]{
+        for (unsigned i{0}; i < count; ) {
+            char byte{static_cast<char>(i % 251)};
+            if (ring.push(&byte, 1))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+    std::string out;
+    while (out.size() < count) {
+        if (ring.pop(out, 37) == 0)
+            std::this_thread::yield();
+    }
+    producer.join();
+    for (unsigned i{0}; i < count; ++i)
+        ASSERT_EQ(out[i], static_cast<char>(i % 251)) << i;
+}
+
+TEST(AsyncLogTest, recordsReadBack) {
+    auto fileName{tempName("records")};
+    {
+        AsyncLog log{fileName};
+        EXPECT_TRUE(log.write(RecordKind::text, "session start"));
+        EXPECT_TRUE(log.write(RecordKind::tx, std::string("\xEE\x00\x00\x00", 4)));
+        EXPECT_TRUE(log.write(RecordKind::rx, std::string(300, '\x06')));
+        EXPECT_TRUE(log.good());
+    }
+    auto records{readBack(fileName)};
+    std::filesystem::remove(fileName);
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[0].kind, RecordKind::text);
+    EXPECT_EQ(records[0].data, "session start");
+    EXPECT_EQ(records[1].kind, RecordKind::tx);
+    EXPECT_EQ(records[1].data, std::string("\xEE\x00\x00\x00", 4));
+    EXPECT_EQ(records[2].kind, RecordKind::rx);
+    EXPECT_EQ(records[2].data, std::string(300, '\x06'));
+    EXPECT_LE(records[0].time, records[2].time);
+    EXPECT_LT(std::chrono::system_clock::now() - records[0].time, std::chrono::minutes{1});
+}
+
+TEST(AsyncLogTest, overflowLeavesGap) {
+    auto fileName{tempName("gap")};
+    AsyncLog::Options options;
+    options.capacity = 64;
+    {
+        AsyncLog log{fileName, options};
+        EXPECT_FALSE(log.write(RecordKind::rx, std::string(100, 'x')));  // can never fit
+        EXPECT_FALSE(log.write(RecordKind::rx, std::string(100, 'y')));
+        EXPECT_EQ(log.dropped(), 2u);
+        EXPECT_TRUE(log.write(RecordKind::tx, "after"));
+    }
+    auto records{readBack(fileName)};
+    std::filesystem::remove(fileName);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].kind, RecordKind::gap);
+    EXPECT_EQ(records[0].lost, 2u);
+    EXPECT_EQ(records[1].data, "after");
+}
+
+TEST(AsyncLogTest, waitKeepsEverything) {
+    auto fileName{tempName("wait")};
+    AsyncLog::Options options;
+    options.capacity = 256;
+    options.overflow = Overflow::wait;
+    constexpr unsigned count{2000};
+    {
+        AsyncLog log{fileName, options};
+        for (unsigned i{0}; i < count; ++i)
+            ASSERT_TRUE(log.write(RecordKind::tx, std::to_string(i)));
+        EXPECT_EQ(log.dropped(), 0u);
+    }
+    auto records{readBack(fileName)};
+    std::filesystem::remove(fileName);
+    ASSERT_EQ(records.size(), count);
+    for (unsigned i{0}; i < count; ++i)
+        ASSERT_EQ(records[i].data, std::to_string(i));
+}
+
+TEST(AsyncLogTest, truncatedLog) {
+    auto fileName{tempName("truncated")};
+    {
+        AsyncLog log{fileName};
+        log.write(RecordKind::tx, "first");
+        log.write(RecordKind::rx, "second");
+    }
+    std::string bytes;
+    {
+        std::ifstream in{fileName, std::ios::binary};
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::filesystem::remove(fileName);
+    std::istringstream cut{bytes.substr(0, bytes.size() - 2)};
+    auto records{readBinaryLog(cut)};
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].data, "first");
+    std::istringstream text{"10:00:00.000 Tx: 06\n"};
+    EXPECT_FALSE(isBinaryLog(text));
+    EXPECT_THROW(readBinaryLog(text), std::runtime_error);
+}
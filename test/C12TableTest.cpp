@@ -3,6 +3,8 @@
 #include <future>
 #include <string>
 #include <sstream>
+#include <variant>
+#include <vector>
 #include "C12Tables.h"
 #include <gtest/gtest.h>
 
@@ -246,5 +248,119 @@ TEST_F(C12TableTest, printTable) {
     std::stringstream ss;
     MT0.printTo(ss);
     std::string s{ss.str()};
-    EXPECT_EQ(s, "TABLE 0 MY_TEST_TBL\n    DIM_ARRAY_ONE = 7\n    ARRAY_ONE = \n    ARRAY_ONE[0] = 7\n    ARRAY_ONE[1] = 0\n    ARRAY_ONE[2] = 1\n    ARRAY_ONE[3] = 2\n    ARRAY_ONE[4] = 3\n    ARRAY_ONE[5] = 4\n    ARRAY_ONE[6] = 5\n\n    GREETING = \"Hello!\"\n    DIM_ARRAY_TWO = 3\n    ARRAY_TWO = \n    ARRAY_TWO[0] = 7\n    ARRAY_TWO[1] = 513\n    ARRAY_TWO[2] = 1027\n\n");
+    EXPECT_EQ(s, "TABLE 0 MY_TEST_TBL\n    DIM_ARRAY_ONE = 7\n    ARRAY_ONE = \n    ARRAY_ONE[0] = 0\n    ARRAY_ONE[1] = 1\n    ARRAY_ONE[2] = 2\n    ARRAY_ONE[3] = 3\n    ARRAY_ONE[4] = 4\n    ARRAY_ONE[5] = 5\n    ARRAY_ONE[6] = 6\n\n    GREETING = \"Hello!\"\n    DIM_ARRAY_TWO = 3\n    ARRAY_TWO = \n    ARRAY_TWO[0] = 4660\n    ARRAY_TWO[1] = 57005\n    ARRAY_TWO[2] = 51966\n\n");
+}
+
+TEST_F(C12TableTest, fieldRefValues) {
+    auto fc3 = ST0.field("FORMAT_CONTROL_3");
+    ASSERT_TRUE(fc3);
+    EXPECT_EQ(fc3->Name(), "FORMAT_CONTROL_3");
+    EXPECT_EQ(fc3->size(), 1);
+    EXPECT_EQ(fc3->value("NI_FORMAT1"), 10);
+    EXPECT_EQ(ST0.field("DEVICE_CLASS")->to_string(), "\"EPRI\"");
+    EXPECT_FALSE(ST0.field("NO_SUCH_FIELD"));
+}
+
+TEST_F(C12TableTest, fieldRefArray) {
+    auto array2 = MT0.field("ARRAY_TWO");
+    ASSERT_TRUE(array2);
+    EXPECT_EQ(array2->size(), 6);
+    EXPECT_EQ(array2->value(2), 0xcafe);
+    EXPECT_EQ(array2->value(2), MT0.value("ARRAY_TWO", 2));
+}
+
+TEST_F(C12TableTest, fieldRefDoesNotAllocate) {
+    auto before = allocationCounters().allocations;
+    auto fld = MT0.field("ARRAY_ONE");
+    auto copy = fld;
+    EXPECT_EQ(copy->value(4), 4);
+    EXPECT_EQ(allocationCounters().allocations, before);
+}
+
+TEST_F(C12TableTest, cloneArray) {
+    auto array2 = MT0["ARRAY_TWO"];
+    ASSERT_TRUE(array2);
+    EXPECT_EQ(array2.value()->size(), 6);
+    EXPECT_EQ(array2.value()->value(mt0.data(), 2), 0xcafe);
+}
+
+TEST_F(C12TableTest, typedValues) {
+    auto nbr = ST0.field("NBR_PENDING")->typed();
+    ASSERT_TRUE(std::holds_alternative<unsigned long>(nbr));
+    EXPECT_EQ(std::get<unsigned long>(nbr), ST0.value("NBR_PENDING"));
+    auto dc = ST0.field("DEVICE_CLASS")->typed();
+    ASSERT_TRUE(std::holds_alternative<Bytes>(dc));
+    EXPECT_EQ(std::string(std::get<Bytes>(dc).begin(), std::get<Bytes>(dc).end()), "EPRI");
+    auto fc3 = ST0.field("FORMAT_CONTROL_3")->typed();
+    ASSERT_TRUE(std::holds_alternative<FieldRef>(fc3));
+    EXPECT_EQ(std::get<FieldRef>(fc3).value("NI_FORMAT1"), 10);
+}
+
+TEST_F(C12TableTest, setBits) {
+    auto used = ST0.field("STD_PROC_USED")->typed();
+    ASSERT_TRUE(std::holds_alternative<SetBits>(used));
+    const auto& bits = std::get<SetBits>(used);
+    std::vector<std::size_t> numbers(bits.begin(), bits.end());
+    EXPECT_EQ(numbers, (std::vector<std::size_t>{3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 14, 20}));
+    EXPECT_EQ(bits.capacity(), 24);
+    EXPECT_TRUE(bits.test(14));
+    EXPECT_FALSE(bits.test(13));
+    EXPECT_FALSE(bits.test(1000));
+    EXPECT_EQ(ST0.value("STD_PROC_USED", 1000), 0);
+}
+
+class RecordTest : public ::testing::Test {
+protected:
+    RecordTest() : tbl{2049, "MY_BLOCK_TBL", "MY_BLOCK_RCD", data} {
+        auto entry = std::make_shared<Record>("ENTRY_RCD");
+        entry->addField("ID", Table::fieldtype::UINT, 1);
+        entry->addField("READINGS", Table::fieldtype::UINT, 2, 2);
+        tbl.addField("COUNT", Table::fieldtype::UINT, 1);
+        tbl.addField("FIRST", entry);
+        tbl.addField("ENTRIES", entry, 3);
+    }
+    const static std::string data;
+    Table tbl;
+};
+
+const std::string RecordTest::data{
+    "\x03"
+    "\x09\x01\x00\x02\x00"
+    "\x0a\x10\x00\x11\x00"
+    "\x0b\x20\x00\x21\x00"
+    "\x0c\x30\x00\x31\x00", 21};
+
+TEST_F(RecordTest, sizes) {
+    EXPECT_EQ(tbl.recordSize(), 21);
+    EXPECT_EQ(tbl.totalSize(), 21);
+    EXPECT_EQ(tbl.field("FIRST")->size(), 5);
+    EXPECT_EQ(tbl.field("ENTRIES")->size(), 15);
+}
+
+TEST_F(RecordTest, memberValues) {
+    EXPECT_EQ(tbl.value("FIRST", "ID"), 9);
+    EXPECT_EQ(tbl.value("ENTRIES", 2, "ID"), 0x0c);
+    EXPECT_EQ(tbl.field("ENTRIES")->value(1, "ID"), 0x0b);
+}
+
+TEST_F(RecordTest, navigate) {
+    auto readings = tbl.field("ENTRIES")->element(2)->member("READINGS");
+    ASSERT_TRUE(readings);
+    EXPECT_EQ(readings->value(1), 0x31);
+    EXPECT_EQ(tbl.field("FIRST")->member("READINGS")->value(0), 1);
+    EXPECT_FALSE(tbl.field("ENTRIES")->element(3));
+    EXPECT_FALSE(tbl.field("FIRST")->member("NO_SUCH_MEMBER"));
+}
+
+TEST_F(RecordTest, bigEndian) {
+    tbl.setDataOrder(true);
+    EXPECT_EQ(tbl.value("ENTRIES", 2, "ID"), 0x0c);
+    EXPECT_EQ(tbl.field("FIRST")->member("READINGS")->value(0), 0x0100);
+    EXPECT_EQ(tbl.field("ENTRIES")->element(2)->member("READINGS")->value(1), 0x3100);
+}
+
+TEST_F(RecordTest, printRecord) {
+    std::stringstream ss;
+    tbl.field("ENTRIES")->element(0)->printTo(ss);
+    EXPECT_EQ(ss.str(), "{\n\tID = 10\n\tREADINGS = \n    READINGS[0] = 16\n    READINGS[1] = 17\n\n    }");
 }
@@ -0,0 +1,92 @@
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ChannelPool.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+struct FakeChannel {
+    explicit FakeChannel(int id) : id{id} {}
+    int id;
+};
+
+static std::unique_ptr<FakeChannel> make(int id) {
+    return std::make_unique<FakeChannel>(id);
+}
+
+TEST(ChannelPoolTest, releasedChannelIsReused) {
+    ChannelPool<FakeChannel> pool;
+    FakeChannel* first;
+    {
+        auto lease{pool.acquire("relay-1", []{ return make(1); })};
+        EXPECT_FALSE(lease.reused());
+        first = lease.get();
+        EXPECT_EQ(pool.size(), 0u);
+    }
+    EXPECT_EQ(pool.size(), 1u);
+    auto lease{pool.acquire("relay-1", []{ return make(2); })};
+    EXPECT_TRUE(lease.reused());
+    EXPECT_EQ(lease.get(), first);
+    EXPECT_EQ(lease->id, 1);
+    EXPECT_EQ(pool.reused(), 1u);
+}
+
+TEST(ChannelPoolTest, keysAreSeparate) {
+    ChannelPool<FakeChannel> pool;
+    pool.acquire("relay-1", []{ return make(1); });
+    auto lease{pool.acquire("relay-2", []{ return make(2); })};
+    EXPECT_FALSE(lease.reused());
+    EXPECT_EQ(lease->id, 2);
+}
+
+TEST(ChannelPoolTest, discardedChannelIsClosed) {
+    ChannelPool<FakeChannel> pool;
+    {
+        auto lease{pool.acquire("relay-1", []{ return make(1); })};
+        lease.discard();
+        EXPECT_EQ(lease.get(), nullptr);
+    }
+    EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST(ChannelPoolTest, createdChannelIsNew) {
+    ChannelPool<FakeChannel> pool;
+    pool.acquire("relay-1", []{ return make(1); });
+    auto lease{pool.create("relay-1", []{ return make(2); })};
+    EXPECT_FALSE(lease.reused());
+    EXPECT_EQ(lease->id, 2);
+    EXPECT_EQ(pool.size(), 1u);
+    EXPECT_EQ(pool.reused(), 0u);
+}
+
+TEST(ChannelPoolTest, idleChannelsAreBounded) {
+    ChannelPool<FakeChannel> pool{2};
+    {
+        std::vector<ChannelPool<FakeChannel>::Lease> leases;
+        for (int i{0}; i < 4; ++i)
+            leases.push_back(pool.acquire("relay-1", [i]{ return make(i); }));
+    }
+    EXPECT_EQ(pool.size(), 2u);
+    ChannelPool<FakeChannel> none{0};
+    none.acquire("relay-1", []{ return make(1); });
+    EXPECT_EQ(none.size(), 0u);
+}
+
+TEST(ChannelPoolTest, concurrentLeases) {
+    ChannelPool<FakeChannel> pool{4};
+    std::vector<std::thread> threads;
+    for (int t{0}; t < 4; ++t) {
+        threads.emplace_back([&pool, t]{
+            for (int i{0}; i < 1000; ++i) {
+                auto lease{pool.acquire("relay-1", [t]{ return make(t); })};
+                ASSERT_NE(lease.get(), nullptr);
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_LE(pool.size(), 4u);
+    EXPECT_GE(pool.reused(), 4000u - 4u);
+}
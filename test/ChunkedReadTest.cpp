@@ -0,0 +1,37 @@
+#include "ChunkedRead.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+TEST(ChunkedReadTest, readsUntilShortChunk) {
+    ChunkedRead read{100};
+    EXPECT_EQ(read.offset(), 0u);
+    EXPECT_EQ(read.size(), 100u);
+    EXPECT_TRUE(read.next(100));
+    EXPECT_EQ(read.offset(), 100u);
+    EXPECT_TRUE(read.next(100));
+    EXPECT_FALSE(read.next(42));
+    EXPECT_EQ(read.offset(), 242u);
+}
+
+TEST(ChunkedReadTest, refusedReadEndsOnlyAfterData) {
+    ChunkedRead read{100};
+    EXPECT_FALSE(read.refused());
+    EXPECT_TRUE(read.next(100));
+    EXPECT_TRUE(read.refused());
+    EXPECT_EQ(read.offset(), 100u);
+}
+
+TEST(ChunkedReadTest, emptyChunkEnds) {
+    ChunkedRead read{0};
+    EXPECT_EQ(read.size(), 1u);
+    EXPECT_FALSE(read.next(0));
+}
+
+TEST(ChunkedReadTest, chunkSizes) {
+    EXPECT_EQ(c1222ChunkSize(8192), 8064u);
+    EXPECT_EQ(c1222ChunkSize(0), 128u);
+    EXPECT_EQ(c1218ChunkSize(64, 1), 52u);
+    EXPECT_EQ(c1218ChunkSize(1024, 255), 1016u * 255 - 4);
+    EXPECT_EQ(c1218ChunkSize(0, 0), 1u);
+}
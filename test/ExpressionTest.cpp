@@ -0,0 +1,90 @@
+#include <map>
+#include <stdexcept>
+#include <string>
+#include "Expression.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+// a resolver over fixed values keyed by the reference as written
+static Expression::Resolver lookup(const std::map<std::string, long>& values) {
+    return [values](const Reference& ref) -> std::optional<long> {
+        std::string key{ref.table.str() + "." + ref.field.str()};
+        if (ref.subfield)
+            key += "." + ref.subfield.str();
+        if (ref.index)
+            key += "[" + std::to_string(*ref.index) + "]";
+        auto it{values.find(key)};
+        if (it == values.end())
+            return std::nullopt;
+        return it->second;
+    };
+}
+
+static long eval(const std::string& text, const std::map<std::string, long>& values = {}) {
+    return Expression{text}.evaluate(lookup(values)).value();
+}
+
+TEST(ExpressionTest, arithmetic) {
+    EXPECT_EQ(eval("42"), 42);
+    EXPECT_EQ(eval("1 + 2 * 3"), 7);
+    EXPECT_EQ(eval("(1 + 2) * 3"), 9);
+    EXPECT_EQ(eval("10 - 4 - 3"), 3);
+    EXPECT_EQ(eval("-2 * -3"), 6);
+    EXPECT_EQ(eval("7 / 2"), 3);
+    EXPECT_EQ(eval("7 / 0"), 0);
+}
+
+TEST(ExpressionTest, logic) {
+    EXPECT_EQ(eval("1 < 2"), 1);
+    EXPECT_EQ(eval("2 <= 1"), 0);
+    EXPECT_EQ(eval("3 == 3 && 4 != 5"), 1);
+    EXPECT_EQ(eval("0 || 2 > 1"), 1);
+    EXPECT_EQ(eval("!0"), 1);
+    EXPECT_EQ(eval("!(1 + 1 == 2)"), 0);
+    EXPECT_EQ(eval("1 || 0 && 0"), 1);
+}
+
+TEST(ExpressionTest, references) {
+    std::map<std::string, long> values{
+        {"GEN_CONFIG_TBL.FORMAT_CONTROL_2.TM_FORMAT", 2},
+        {"GEN_CONFIG_TBL.STD_TBLS_USED[64]", 1},
+        {"ACT_REGS_TBL.NBR_SUMMATIONS", 4},
+    };
+    EXPECT_EQ(eval("GEN_CONFIG_TBL.FORMAT_CONTROL_2.TM_FORMAT == 2", values), 1);
+    EXPECT_EQ(eval("GEN_CONFIG_TBL.STD_TBLS_USED[64]", values), 1);
+    EXPECT_EQ(eval("ACT_REGS_TBL.NBR_SUMMATIONS * 2", values), 8);
+    Expression expr{"GEN_CONFIG_TBL.STD_TBLS_USED[ 64 ] && ACT_REGS_TBL.NBR_SUMMATIONS"};
+    ASSERT_EQ(expr.references().size(), 2u);
+    EXPECT_EQ(expr.references()[0].table.str(), "GEN_CONFIG_TBL");
+    EXPECT_EQ(expr.references()[0].index, std::optional<std::size_t>{64});
+    EXPECT_FALSE(expr.references()[1].subfield);
+}
+
+TEST(ExpressionTest, missingTable) {
+    Expression expr{"1 + ACT_LOG_TBL.NBR_STD_EVENTS"};
+    EXPECT_FALSE(expr.evaluate(lookup({})).has_value());
+    EXPECT_EQ(expr.evaluate(lookup({{"ACT_LOG_TBL.NBR_STD_EVENTS", 5}})), 6);
+}
+
+TEST(ExpressionTest, syntaxErrors) {
+    EXPECT_THROW(Expression{""}, std::invalid_argument);
+    EXPECT_THROW(Expression{"1 +"}, std::invalid_argument);
+    EXPECT_THROW(Expression{"(1"}, std::invalid_argument);
+    EXPECT_THROW(Expression{"1 2"}, std::invalid_argument);
+    EXPECT_THROW(Expression{"TABLE"}, std::invalid_argument);
+    EXPECT_THROW(Expression{"TABLE.FIELD[x]"}, std::invalid_argument);
+    EXPECT_THROW(Expression{"99999999999999999999999"}, std::invalid_argument);
+    EXPECT_THROW(Expression{"1 = 1"}, std::invalid_argument);
+}
+
+TEST(ExpressionTest, tooDeep) {
+    std::string deep{"0"};
+    for (int i{1}; i < 40; ++i)
+        deep = std::to_string(i) + " + (" + deep + ")";
+    EXPECT_THROW(Expression{deep}, std::invalid_argument);
+    std::string wide{"0"};
+    for (int i{1}; i < 100; ++i)
+        wide += " + " + std::to_string(i);
+    EXPECT_EQ(eval(wide), 4950);
+}
@@ -0,0 +1,53 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "Fleet.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+TEST(FleetTest, defaultsAndMeters) {
+    std::istringstream in{
+        "; shared by every meter\n"
+        "[protocol]\n"
+        "TYPE=PROTOCOL_ANSI_C12_22\n"
+        "PASSWORD=\"55555555555555555555\"\n"
+        "[channel]\n"
+        "TYPE=CHANNEL_SOCKET\n"
+        "PEER_PORT=1153\n"
+        "\n"
+        "[meter]\n"
+        "NAME=north-1\n"
+        "TABLES=ST1 ST5  ST23\n"
+        "PEER_ADDRESS=10.0.0.1\n"
+        "[meter]\n"
+        "PEER_ADDRESS = 10.0.0.2\n"
+        "CALLED_AP_TITLE=2.16.124.113620.1.22.0\n"
+    };
+    auto fleet{readFleet(in)};
+    EXPECT_EQ(propertyString(fleet.protocol), "TYPE=PROTOCOL_ANSI_C12_22;PASSWORD=\"55555555555555555555\"");
+    EXPECT_EQ(propertyString(fleet.channel), "TYPE=CHANNEL_SOCKET;PEER_PORT=1153");
+    ASSERT_EQ(fleet.meters.size(), 2u);
+    EXPECT_EQ(fleet.meters[0].name, "north-1");
+    EXPECT_EQ(fleet.meters[0].tables, (std::vector<std::string>{"ST1", "ST5", "ST23"}));
+    EXPECT_EQ(propertyString(fleet.meters[0].properties), "PEER_ADDRESS=10.0.0.1");
+    EXPECT_EQ(fleet.meters[1].name, "meter2");
+    EXPECT_TRUE(fleet.meters[1].tables.empty());
+    EXPECT_EQ(propertyString(fleet.meters[1].properties), "PEER_ADDRESS=10.0.0.2;CALLED_AP_TITLE=2.16.124.113620.1.22.0");
+}
+
+TEST(FleetTest, badSection) {
+    std::istringstream in{"[protocol]\nTYPE=PROTOCOL_ANSI_C12_18\n[meters]\n"};
+    try {
+        readFleet(in);
+        FAIL() << "no exception";
+    }
+    catch (std::runtime_error& ex) {
+        EXPECT_EQ(std::string{ex.what()}.substr(0, 7), "line 3:");
+    }
+}
+
+TEST(FleetTest, valueOutsideSection) {
+    std::istringstream in{"NAME=north-1\n"};
+    EXPECT_THROW(readFleet(in), std::runtime_error);
+}
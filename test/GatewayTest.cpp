@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Gateway.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+namespace {
+    // stands in for a meter: every read takes a while and bumps the value
+    struct FakeMeter {
+        std::atomic<int> reads{0};
+        std::chrono::milliseconds delay{0};
+        Gateway gateway{
+            [this](const std::string& item) {
+                if (item == "ST99")
+                    throw std::runtime_error("table ST99 is not available");
+                std::this_thread::sleep_for(delay);
+                ++reads;
+            },
+            [this](const std::string& expression) { return expression + '=' + std::to_string(reads); }};
+    };
+
+    // a meter whose reads store a table the way a Meter does, queried as c12test's gateway is
+    struct SnapshotMeter {
+        TableRegistry tables;
+        SnapshotCell snapshots;
+        std::uint64_t sessions{0};
+        Gateway gateway{
+            [this](const std::string&) {
+                auto block{std::make_shared<Record>("TOT_DATA_RCD")};
+                block->addField("SUMMATIONS", Table::fieldtype::UINT, 4, 2);
+                block->addField("DEMAND", Table::fieldtype::UINT, 2);
+                Table tbl{23, "CURRENT_REG_DATA_TBL", "CURRENT_REG_DATA_RCD",
+                    std::string{"\x05\x12\x00\x00\x00\x34\x00\x00\x00\x07\x00", 11}};
+                tbl.addField("NBR_DEMAND_RESETS", Table::fieldtype::UINT, 1);
+                tbl.addField("TOT_DATA_BLOCK", block);
+                tables.store(std::move(tbl));
+                snapshots.store(std::make_shared<const TableSnapshot>(tables, ++sessions));
+            },
+            snapshotQuery([this]{ return snapshots.load(); })};
+    };
+}
+
+TEST(GatewayTest, freshItemsAreNotReadAgain) {
+    FakeMeter meter;
+    EXPECT_EQ(meter.gateway.handle("ST23 60 REG"), "REG=1");
+    EXPECT_EQ(meter.gateway.handle("ST23 60 REG"), "REG=1");
+    EXPECT_EQ(meter.gateway.handle("ST52 60 CLOCK"), "CLOCK=2");
+    EXPECT_EQ(meter.gateway.handle("ST23 0 REG"), "REG=3");     // no age is fresh enough
+    EXPECT_EQ(meter.gateway.reads(), 3u);
+}
+
+TEST(GatewayTest, errors) {
+    FakeMeter meter;
+    EXPECT_EQ(meter.gateway.handle("ST99 60 X"), "ERROR table ST99 is not available");
+    EXPECT_EQ(meter.gateway.handle("ST23 REG"), "ERROR expected: <item> <max-age-seconds> <expression>");
+    EXPECT_EQ(meter.gateway.handle("ST23 60"), "ERROR expected: <item> <max-age-seconds> <expression>");
+    EXPECT_EQ(meter.gateway.handle(""), "ERROR expected: <item> <max-age-seconds> <expression>");
+}
+
+TEST(GatewayTest, concurrentQueriesShareARead) {
+    FakeMeter meter;
+    meter.delay = std::chrono::milliseconds{200};
+    std::vector<std::string> answers(8);
+    std::vector<std::thread> clients;
+    for (std::size_t i{0}; i < answers.size(); ++i)
+        clients.emplace_back([&, i]{ answers[i] = meter.gateway.handle("ST23 60 REG"); });
+    for (auto& t : clients)
+        t.join();
+    EXPECT_EQ(meter.reads, 1);
+    EXPECT_EQ(meter.gateway.shared(), answers.size() - 1);
+    for (const auto& answer : answers)
+        EXPECT_EQ(answer, "REG=1");
+}
+
+static std::string ask(const std::string& path, const std::string& request) {
+    int fd{::socket(AF_UNIX, SOCK_STREAM, 0)};
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path.c_str());
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof address) != 0) {
+        ::close(fd);
+        return "cannot connect";
+    }
+    EXPECT_EQ(::write(fd, request.data(), request.size()), static_cast<ssize_t>(request.size()));
+    std::string answer;
+    char ch;
+    while (::read(fd, &ch, 1) == 1 && answer.size() < 1000) {
+        answer.push_back(ch);
+        if (std::count(answer.begin(), answer.end(), '\n') == std::count(request.begin(), request.end(), '\n'))
+            break;
+    }
+    ::close(fd);
+    return answer;
+}
+
+TEST(GatewayTest, overSocket) {
+    auto path{(std::filesystem::temp_directory_path() / "c12test-gateway.sock").string()};
+    {
+        FakeMeter meter;
+        meter.gateway.listen(path);
+        // only the user running the gateway may connect
+        EXPECT_EQ(std::filesystem::status(path).permissions() & std::filesystem::perms::all,
+            std::filesystem::perms::owner_read | std::filesystem::perms::owner_write);
+        std::thread server([&]{ meter.gateway.serve(); });
+        EXPECT_EQ(ask(path, "ST23 60 REG\n"), "REG=1\n");
+        EXPECT_EQ(ask(path, "ST23 60 REG\r\nST52 60 CLOCK\n"), "REG=1\nCLOCK=2\n");
+        meter.gateway.stop();
+        server.join();
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(GatewayTest, snapshotQueries) {
+    SnapshotMeter meter;
+    EXPECT_EQ(meter.gateway.handle("ST23 60 CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK.SUMMATIONS[0]"), "18");
+    EXPECT_EQ(meter.gateway.handle("ST23 60 CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK.SUMMATIONS[1]"), "52");
+    EXPECT_EQ(meter.gateway.handle("ST23 60 CURRENT_REG_DATA_TBL.NBR_DEMAND_RESETS"), "5");
+    EXPECT_EQ(meter.gateway.handle("ST23 60 CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK"),
+        "ERROR CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK is not a single value");
+    EXPECT_EQ(meter.gateway.handle("ST23 60 CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK.SUMMATIONS"),
+        "ERROR CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK.SUMMATIONS is not a single value");
+    EXPECT_EQ(meter.gateway.handle("ST23 60 CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK.SUMMATIONS[2]"),
+        "ERROR no value for CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK.SUMMATIONS[2]");
+    EXPECT_EQ(meter.gateway.reads(), 1u);
+
+    // every answer is one line, so a client reading lines stays in step
+    auto path{(std::filesystem::temp_directory_path() / "c12test-gateway-snapshot.sock").string()};
+    meter.gateway.listen(path);
+    std::thread server([&]{ meter.gateway.serve(); });
+    EXPECT_EQ(ask(path, "ST23 60 CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK\nST23 60 CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK.DEMAND\n"),
+        "ERROR CURRENT_REG_DATA_TBL.TOT_DATA_BLOCK is not a single value\n7\n");
+    meter.gateway.stop();
+    server.join();
+}
+
+static int connectTo(const std::string& path) {
+    int fd{::socket(AF_UNIX, SOCK_STREAM, 0)};
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path.c_str());
+    EXPECT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof address), 0);
+    return fd;
+}
+
+static void waitFor(const std::function<bool()>& condition) {
+    for (int i{0}; i < 500 && !condition(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+}
+
+TEST(GatewayTest, connectionsAreLimited) {
+    auto path{(std::filesystem::temp_directory_path() / "c12test-gateway-limit.sock").string()};
+    FakeMeter meter;
+    meter.gateway.listen(path);
+    std::thread server([&]{ meter.gateway.serve(); });
+    // connections that ended are let go of
+    for (int i{0}; i < 50; ++i)
+        EXPECT_EQ(ask(path, "ST23 60 REG\n"), "REG=1\n");
+    waitFor([&]{ return meter.gateway.connected() == 0; });
+    EXPECT_EQ(meter.gateway.connected(), 0u);
+
+    std::vector<int> idle;
+    for (std::size_t i{0}; i < Gateway::maxConnections; ++i)
+        idle.push_back(connectTo(path));
+    waitFor([&]{ return meter.gateway.connected() == Gateway::maxConnections; });
+    EXPECT_EQ(ask(path, "ST23 60 REG\n"), "ERROR too many connections\n");
+    ::close(idle.back());
+    idle.pop_back();
+    waitFor([&]{ return meter.gateway.connected() < Gateway::maxConnections; });
+    EXPECT_EQ(ask(path, "ST23 60 REG\n"), "REG=1\n");
+    for (auto fd : idle)
+        ::close(fd);
+    meter.gateway.stop();
+    server.join();
+}
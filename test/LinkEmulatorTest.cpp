@@ -0,0 +1,85 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include "LinkEmulator.h"
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+using namespace C12;
+
+static std::string readFor(int fd, std::size_t want, int timeout_ms = 2000) {
+    std::string got;
+    char buf[256];
+    while (got.size() < want) {
+        pollfd p{fd, POLLIN, 0};
+        if (poll(&p, 1, timeout_ms) <= 0)
+            break;
+        auto n{::read(fd, buf, sizeof buf)};
+        if (n <= 0)
+            break;
+        got.append(buf, n);
+    }
+    return got;
+}
+
+TEST(LinkEmulatorTest, identPacketCrc) {
+    // the well known C12.18 identify request
+    auto pkt{makePacket(0, 0, std::string{"\x20"})};
+    EXPECT_EQ(pkt, std::string("\xEE\x00\x00\x00\x00\x01\x20\x13\x10", 9));
+}
+
+TEST(LinkEmulatorTest, transferTime) {
+    LinkModel model;
+    model.baud = 9600;
+    model.byteDelay = std::chrono::microseconds{100};
+    model.turnAround = std::chrono::microseconds{20000};
+    EXPECT_EQ(model.byteTime().count(), 1141);
+    EXPECT_EQ(model.transferTime(10).count(), 20000 + 11410);
+}
+
+TEST(LinkEmulatorTest, loopbackRead) {
+    LinkModel model;
+    model.baud = 115200;
+    model.turnAround = std::chrono::microseconds{5000};
+    LinkEmulator link{model};
+    link.open("LOOPBACK");
+    int fd = ::open(link.portName().c_str(), O_RDWR | O_NOCTTY);
+    ASSERT_GE(fd, 0);
+    std::string request{"\x30\x00\x01", 3};
+    auto pkt{makePacket(0, 0, request)};
+    auto start{std::chrono::steady_clock::now()};
+    ASSERT_EQ(::write(fd, pkt.data(), pkt.size()), static_cast<ssize_t>(pkt.size()));
+    // ACK, then a packet holding ok, count, 32 bytes of ST1 and a checksum
+    auto reply{readFor(fd, 1 + 8 + 36)};
+    auto elapsed{std::chrono::steady_clock::now() - start};
+    ASSERT_EQ(reply.size(), 45u);
+    EXPECT_EQ(reply[0], '\x06');
+    EXPECT_EQ(reply[7], '\x00');
+    EXPECT_EQ(reply.substr(10, 12), "EPRISIMULATR");
+    EXPECT_GE(elapsed, model.transferTime(pkt.size()) + model.transferTime(reply.size()));
+    char ack{'\x06'};
+    ASSERT_EQ(::write(fd, &ack, 1), 1);
+    ::close(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    link.close();
+    auto stats{link.statistics()};
+    EXPECT_EQ(stats.bytesToPeer, pkt.size() + 1);
+    EXPECT_EQ(stats.bytesFromPeer, reply.size());
+}
+
+TEST(LinkEmulatorTest, dropEverything) {
+    LinkModel model;
+    model.baud = 115200;
+    model.dropRate = 1.0;
+    LinkEmulator link{model};
+    link.open("LOOPBACK");
+    int fd = ::open(link.portName().c_str(), O_RDWR | O_NOCTTY);
+    ASSERT_GE(fd, 0);
+    auto pkt{makePacket(0, 0, std::string{"\x20"})};
+    ASSERT_EQ(::write(fd, pkt.data(), pkt.size()), static_cast<ssize_t>(pkt.size()));
+    EXPECT_TRUE(readFor(fd, 1, 300).empty());
+    ::close(fd);
+    EXPECT_EQ(link.statistics().bytesDropped, pkt.size());
+}
@@ -0,0 +1,87 @@
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "AsyncLog.h"
+#include "C1218Packet.h"
+#include "MonitorLog.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+static std::string hex(const std::string& bytes) {
+    std::ostringstream ss;
+    for (unsigned char ch : bytes)
+        ss << ' ' << std::uppercase << std::hex << std::setw(2) << std::setfill('0') << unsigned(ch);
+    return ss.str();
+}
+
+static std::string readResponse(const std::string& data) {
+    uint8_t sum{0};
+    for (auto ch : data)
+        sum += static_cast<uint8_t>(ch);
+    return std::string{'\0', static_cast<char>(data.size() >> 8), static_cast<char>(data.size())}
+        + data + static_cast<char>(-sum);
+}
+
+TEST(MonitorLogTest, fullRead) {
+    std::stringstream log;
+    log << "10:00:00.000 Tx:" << hex(makePacket(0, 0, std::string("\x30\x00\x05", 3))) << '\n'
+        << "10:00:00.010 Rx: 06\n"
+        << "10:00:00.050 Rx:" << hex(makePacket(0, 0, readResponse("METER-5"))) << '\n'
+        << "10:00:00.060 Tx: 06\n";
+    auto images{extractTableImages(log)};
+    ASSERT_EQ(images.size(), 1u);
+    EXPECT_EQ(images[0].number, 5);
+    EXPECT_EQ(images[0].data, "METER-5");
+}
+
+TEST(MonitorLogTest, multiPacketWithRetry) {
+    auto response{readResponse("EPRI" "SIMULATR")};
+    auto first{makePacket(0xC0, 1, response.substr(0, 6))};
+    auto second{makePacket(0xA0, 0, response.substr(6))};
+    std::stringstream log;
+    log << "Tx:" << hex(makePacket(0x20, 0, std::string("\x30\x00\x01", 3))) << '\n'
+        << "Rx: 06" << hex(first) << '\n'
+        << "Tx: 06\n"
+        << "Rx:" << hex(first) << '\n'     // repeated because the ACK was lost
+        << "Tx: 06\n"
+        << "Rx:" << hex(second) << '\n';
+    auto images{extractTableImages(log)};
+    ASSERT_EQ(images.size(), 1u);
+    EXPECT_EQ(images[0].number, 1);
+    EXPECT_EQ(images[0].data, "EPRISIMULATR");
+}
+
+TEST(MonitorLogTest, joinPartialReads) {
+    std::stringstream log;
+    log << "Tx:" << hex(makePacket(0, 0, std::string("\x3F\x08\x01\x00\x00\x00\x00\x03", 8))) << '\n'
+        << "Rx:" << hex(makePacket(0, 0, readResponse("abc"))) << '\n'
+        << "Tx:" << hex(makePacket(0x20, 0, std::string("\x3F\x08\x01\x00\x00\x03\x00\x03", 8))) << '\n'
+        << "Rx:" << hex(makePacket(0x20, 0, readResponse("def"))) << '\n'
+        << "some unrelated line\n";
+    auto images{extractTableImages(log)};
+    ASSERT_EQ(images.size(), 1u);
+    EXPECT_EQ(images[0].number, 2049);
+    EXPECT_EQ(images[0].data, "abcdef");
+}
+
+TEST(MonitorLogTest, binaryLog) {
+    auto fileName{(std::filesystem::temp_directory_path() / "c12test-monitorlog.bin").string()};
+    {
+        AsyncLog log{fileName};
+        log.write(RecordKind::text, "C12.18 session");
+        log.write(RecordKind::tx, makePacket(0, 0, std::string("\x30\x00\x05", 3)));
+        log.write(RecordKind::rx, "\x06");
+        log.write(RecordKind::rx, makePacket(0, 0, readResponse("METER-5")));
+        log.write(RecordKind::tx, "\x06");
+    }
+    std::ifstream in{fileName, std::ios::binary};
+    auto images{extractTableImages(in)};
+    in.close();
+    std::filesystem::remove(fileName);
+    ASSERT_EQ(images.size(), 1u);
+    EXPECT_EQ(images[0].number, 5);
+    EXPECT_EQ(images[0].data, "METER-5");
+}
@@ -0,0 +1,58 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ReadPlan.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+static const Model kv2{"EE", "KV2", "3.1"};
+
+TEST(ReadPlanTest, unknownMeterReadsDiscoveryOnly) {
+    PlanCache plans;
+    EXPECT_EQ(plans.firstRead("north-1"), (std::vector<std::string>{"ST0", "ST1"}));
+}
+
+TEST(ReadPlanTest, learnedPlanIsReadWithST0) {
+    PlanCache plans;
+    EXPECT_TRUE(plans.learn("north-1", kv2, {"ST0", "ST1", "ST3", "MT0"}));
+    EXPECT_FALSE(plans.learn("north-1", kv2, {"ST0", "ST1", "ST3", "MT0"}));
+    EXPECT_EQ(plans.firstRead("north-1"), (std::vector<std::string>{"ST0", "ST1", "ST3", "MT0"}));
+    EXPECT_TRUE(plans.learn("north-1", kv2, {"ST0", "ST1", "ST5"}));
+    EXPECT_EQ(plans.firstRead("north-1"), (std::vector<std::string>{"ST0", "ST1", "ST5"}));
+    plans.forget("north-1");
+    EXPECT_EQ(plans.firstRead("north-1"), (std::vector<std::string>{"ST0", "ST1"}));
+}
+
+TEST(ReadPlanTest, nothingLearnedWithoutModel) {
+    PlanCache plans;
+    EXPECT_FALSE(plans.learn("north-1", Model{}, {"ST0", "ST1"}));
+    EXPECT_FALSE(plans.learn("north-1", kv2, {}));
+    EXPECT_EQ(plans.firstRead("north-1").size(), 2u);
+}
+
+TEST(ReadPlanTest, writtenFileIsReadBack) {
+    PlanCache plans;
+    plans.learn("north-1", kv2, {"ST0", "ST1", "ST3"});
+    plans.learn("north-2", kv2, {"ST0", "ST1", "ST3"});
+    plans.learn("south-1", Model{"GE", "I210", "1.0"}, {"ST0", "ST1", "ST23"});
+    std::ostringstream out;
+    plans.write(out);
+    EXPECT_EQ(out.str(),
+        "[model]\nMANUFACTURER=EE\nED_MODEL=KV2\nFIRMWARE=3.1\nTABLES=ST0 ST1 ST3\nMETERS=north-1 north-2\n\n"
+        "[model]\nMANUFACTURER=GE\nED_MODEL=I210\nFIRMWARE=1.0\nTABLES=ST0 ST1 ST23\nMETERS=south-1\n\n");
+    PlanCache copy;
+    std::istringstream in{out.str()};
+    copy.read(in);
+    EXPECT_EQ(copy.firstRead("north-2"), (std::vector<std::string>{"ST0", "ST1", "ST3"}));
+    EXPECT_EQ(copy.firstRead("south-1"), (std::vector<std::string>{"ST0", "ST1", "ST23"}));
+}
+
+TEST(ReadPlanTest, badFile) {
+    PlanCache plans;
+    std::istringstream values{"TABLES=ST0\n"};
+    EXPECT_THROW(plans.read(values), std::runtime_error);
+    std::istringstream names{"[model]\nSERIAL=1\n"};
+    EXPECT_THROW(plans.read(names), std::runtime_error);
+}
@@ -0,0 +1,62 @@
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Schedule.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+using std::chrono::seconds;
+
+TEST(ScheduleTest, firstPollReadsEverything) {
+    Schedule sched;
+    auto t0{Schedule::clock::time_point{}};
+    sched.add("ST3", seconds{60}, t0);
+    sched.add("ST64", seconds{3600}, t0);
+    EXPECT_EQ(sched.due(t0), (std::vector<std::string>{"ST3", "ST64"}));
+    EXPECT_EQ(sched.next(), t0 + seconds{60});
+}
+
+TEST(ScheduleTest, intervalsAreIndependent) {
+    Schedule sched;
+    auto t0{Schedule::clock::time_point{}};
+    sched.add("ST3", seconds{60}, t0);
+    sched.add("ST64", seconds{3600}, t0);
+    sched.due(t0);
+    EXPECT_TRUE(sched.due(t0 + seconds{59}).empty());
+    EXPECT_EQ(sched.due(t0 + seconds{60}), std::vector<std::string>{"ST3"});
+    EXPECT_EQ(sched.due(t0 + seconds{3600}), (std::vector<std::string>{"ST3", "ST64"}));
+}
+
+TEST(ScheduleTest, missedReadsAreSkipped) {
+    Schedule sched;
+    auto t0{Schedule::clock::time_point{}};
+    sched.add("ST3", seconds{60}, t0);
+    sched.due(t0);
+    EXPECT_EQ(sched.due(t0 + seconds{250}), std::vector<std::string>{"ST3"});
+    EXPECT_EQ(sched.next(), t0 + seconds{310});
+}
+
+static std::vector<std::string> ordered(const Priorities& priorities, const std::vector<std::string>& items) {
+    std::vector<std::string> result;
+    for (auto i : priorities.order(items))
+        result.push_back(items[i]);
+    return result;
+}
+
+TEST(ScheduleTest, priorityOrder) {
+    Priorities priorities;
+    EXPECT_EQ(ordered(priorities, {"ST5", "ST23", "ST1", "ST64", "ST52", "ST21", "ST0"}),
+        (std::vector<std::string>{"ST1", "ST0", "ST52", "ST23", "ST21", "ST5", "ST64"}));
+    priorities.set("ST64", 60);
+    priorities.set("ST52", -1);
+    EXPECT_EQ(priorities.of("ST64"), 60);
+    EXPECT_EQ(priorities.of("MT7"), 0);
+    EXPECT_EQ(ordered(priorities, {"ST52", "ST5", "ST64"}), (std::vector<std::string>{"ST64", "ST5", "ST52"}));
+}
+
+TEST(ScheduleTest, itemsStayOnTheirSideOfFunctions) {
+    Priorities priorities;
+    EXPECT_EQ(ordered(priorities, {"ST5", "ST52", "SF3()", "ST7", "ST23", "MF1(01)", "ST1"}),
+        (std::vector<std::string>{"ST52", "ST5", "SF3()", "ST23", "ST7", "MF1(01)", "ST1"}));
+    EXPECT_TRUE(priorities.order({}).empty());
+}
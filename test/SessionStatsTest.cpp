@@ -0,0 +1,56 @@
+#include <chrono>
+#include <sstream>
+#include <string>
+#include "SessionStats.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+using std::chrono::microseconds;
+
+TEST(SessionStatsTest, smallValuesExact) {
+    Histogram h;
+    for (int i{1}; i <= 10; ++i)
+        h.add(microseconds{i});
+    EXPECT_EQ(h.count(), 10u);
+    EXPECT_EQ(h.percentile(50).count(), 5);
+    EXPECT_EQ(h.percentile(95).count(), 10);
+    EXPECT_EQ(h.total().count(), 55);
+}
+
+TEST(SessionStatsTest, largeValuesBounded) {
+    Histogram h;
+    for (int i{1}; i <= 1000; ++i)
+        h.add(microseconds{i * 1000});
+    auto p50{h.percentile(50).count()};
+    auto p99{h.percentile(99).count()};
+    EXPECT_GE(p50, 500000);
+    EXPECT_LE(p50, 500000 * 17 / 16);
+    EXPECT_GE(p99, 990000);
+    EXPECT_LE(p99, 1000000);
+    EXPECT_EQ(h.max().count(), 1000000);
+}
+
+TEST(SessionStatsTest, emptyHistogram) {
+    Histogram h;
+    EXPECT_EQ(h.percentile(99).count(), 0);
+}
+
+TEST(SessionStatsTest, phasesAndJson) {
+    SessionStats stats;
+    stats.record(Phase::Connect, "", PhaseSample{microseconds{1000}, 0, 0, 0});
+    stats.record(Phase::Read, "ST1", PhaseSample{microseconds{20000}, 10, 50, 1});
+    stats.record(Phase::Read, "ST5", PhaseSample{microseconds{30000}, 10, 40, 0});
+    stats.record(Phase::Decode, "ST1", PhaseSample{microseconds{12}, 0, 0, 0});
+    stats.sessionDone(false);
+    EXPECT_EQ(stats.sessions(), 1u);
+    EXPECT_EQ(stats.histogram(Phase::Read).count(), 2u);
+    EXPECT_EQ(stats.bytes(Phase::Read), 110u);
+    EXPECT_EQ(stats.retries(Phase::Read), 1u);
+    std::stringstream ss;
+    stats.writeJson(ss);
+    auto json{ss.str()};
+    EXPECT_NE(json.find("\"sessions\": 1"), std::string::npos);
+    EXPECT_NE(json.find("\"connect\": {\"count\": 1, \"p50_us\": 1000"), std::string::npos);
+    EXPECT_NE(json.find("\"ST5\": {\"count\": 1"), std::string::npos);
+    EXPECT_NE(json.find("\"decodes\": {\n    \"ST1\""), std::string::npos);
+}
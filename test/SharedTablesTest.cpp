@@ -0,0 +1,126 @@
+#include <memory>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <unistd.h>
+#include "SharedTables.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+static std::string segmentName(const std::string& what) {
+    return "/c12test-" + what + "-" + std::to_string(::getpid());
+}
+
+// a table with every kind of field
+static Table buildTable(uint8_t fill) {
+    std::string data{'\x81', 'A', 'B', 'C', '\x05'};
+    for (int i{0}; i < 11; ++i)
+        data.push_back(static_cast<char>(fill + i));
+    auto entry{std::make_shared<Record>("ENTRY_RCD")};
+    entry->addField("ID", Table::fieldtype::UINT, 1);
+    entry->addField("VALUE", Table::fieldtype::UINT, 2);
+    Table tbl{23, "SHM_TEST_TBL", "SHM_TEST_RCD", data};
+    tbl.addField("FLAGS", Table::fieldtype::BITFIELD, 1);
+    tbl.addSubfield("FLAGS", "LOW", 0, 3);
+    tbl.addSubfield("FLAGS", "HIGH", 7);
+    tbl.addField("NAME", Table::fieldtype::STRING, 3);
+    tbl.addField("USED", Table::fieldtype::SET, 1);
+    tbl.addField("TOTAL", entry);
+    tbl.addField("ENTRIES", entry, 2);
+    tbl.addField("SPARE", Table::fieldtype::UINT, 1, 2);
+    return tbl;
+}
+
+static std::shared_ptr<const Table> makeTable(uint8_t fill) {
+    return std::make_shared<const Table>(buildTable(fill));
+}
+
+static std::string printed(const FieldRef& fld) {
+    std::ostringstream out;
+    fld.printTo(out);
+    return out.str();
+}
+
+TEST(SharedTablesTest, fieldsReadInPlace) {
+    auto name{segmentName("fields")};
+    SharedTables shared{name};
+    SharedTablesReader reader{name};
+    EXPECT_EQ(reader.read([](const std::vector<SharedTable>&) { FAIL() << "nothing was published"; }), 0u);
+
+    auto tbl{makeTable(0x10)};
+    shared.publish({tbl});
+    std::size_t seen{0};
+    EXPECT_EQ(reader.read([&](const std::vector<SharedTable>& tables) {
+        ASSERT_EQ(tables.size(), 1u);
+        const auto& published{tables[0]};
+        EXPECT_EQ(published.Number(), 23u);
+        EXPECT_EQ(published.Name(), "SHM_TEST_TBL");
+        EXPECT_EQ(published.image().size(), tbl->dataSize());
+        for (const auto& fld : *tbl) {
+            auto original{tbl->field(fld->Name())};
+            auto copy{published.field(fld->Name())};
+            ASSERT_TRUE(copy) << fld->Name();
+            EXPECT_EQ(printed(*copy), printed(*original)) << fld->Name();
+            ++seen;
+        }
+        EXPECT_EQ(published.field("FLAGS")->value("HIGH"), 1u);
+        EXPECT_EQ(published.field("ENTRIES")->element(1)->member("VALUE")->value(), 0x1817u);
+        EXPECT_FALSE(published.field("MISSING"));
+    }), 1u);
+    EXPECT_EQ(seen, tbl->size());
+}
+
+TEST(SharedTablesTest, byteOrder) {
+    auto name{segmentName("order")};
+    SharedTables shared{name};
+    SharedTablesReader reader{name};
+    auto tbl{buildTable(0x10)};
+    tbl.setDataOrder(true);
+    shared.publish({std::make_shared<const Table>(std::move(tbl))});
+    reader.read([](const std::vector<SharedTable>& tables) {
+        ASSERT_EQ(tables.size(), 1u);
+        EXPECT_TRUE(tables[0].bigEndian());
+        EXPECT_EQ(tables[0].field("ENTRIES")->element(1)->member("VALUE")->value(), 0x1718u);
+    });
+}
+
+TEST(SharedTablesTest, readersFollowPublications) {
+    auto name{segmentName("follow")};
+    SharedTables shared{name};
+    SharedTablesReader reader{name};
+    TableRegistry registry;
+    registry.store(buildTable(1));
+    shared.publish(TableSnapshot{registry, 1});
+    const Record* layout{nullptr};
+    unsigned id{0};
+    EXPECT_EQ(reader.read([&](const std::vector<SharedTable>& tables) {
+        layout = &tables.at(0).layout();
+        id = tables.at(0).field("TOTAL")->member("ID")->value();
+    }), 1u);
+    EXPECT_EQ(id, 1u);
+
+    // a publication to the slot being read sends the reader round again
+    int calls{0};
+    EXPECT_EQ(reader.read([&](const std::vector<SharedTable>& tables) {
+        if (++calls == 1) {
+            shared.publish({makeTable(2)});
+            shared.publish({makeTable(3)});
+        }
+        id = tables.at(0).field("TOTAL")->member("ID")->value();
+        // the layout is built once and kept while it is unchanged
+        EXPECT_EQ(&tables.at(0).layout(), layout);
+    }), 3u);
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(id, 3u);
+    EXPECT_EQ(reader.generation(), 3u);
+}
+
+TEST(SharedTablesTest, limits) {
+    EXPECT_THROW(SharedTablesReader{segmentName("absent")}, std::system_error);
+    auto name{segmentName("small")};
+    SharedTables shared{name, 64};
+    EXPECT_THROW(shared.publish({makeTable(0)}), std::runtime_error);
+    EXPECT_EQ(shared.generation(), 0u);
+}
@@ -0,0 +1,73 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SingleFlight.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+TEST(SingleFlightTest, concurrentCallsRunOnce) {
+    SingleFlight<std::string> flights;
+    std::atomic<int> runs{0};
+    std::atomic<bool> release{false};
+    std::thread leader([&]{
+        flights.run("ST23", [&]{
+            ++runs;
+            while (!release)
+                std::this_thread::yield();
+        });
+    });
+    while (runs == 0)
+        std::this_thread::yield();
+    std::vector<std::thread> followers;
+    for (int i{0}; i < 4; ++i)
+        followers.emplace_back([&]{ flights.run("ST23", [&]{ ++runs; }); });
+    while (flights.shared() < 4)
+        std::this_thread::yield();
+    release = true;
+    leader.join();
+    for (auto& t : followers)
+        t.join();
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(flights.shared(), 4u);
+}
+
+TEST(SingleFlightTest, keysAreIndependentAndNotCached) {
+    SingleFlight<std::string> flights;
+    int runs{0};
+    flights.run("ST1", [&]{ ++runs; });
+    flights.run("ST1", [&]{ ++runs; });
+    flights.run("ST2", [&]{ ++runs; });
+    EXPECT_EQ(runs, 3);
+    EXPECT_EQ(flights.shared(), 0u);
+}
+
+TEST(SingleFlightTest, waitersGetTheException) {
+    SingleFlight<int> flights;
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    std::thread leader([&]{
+        EXPECT_THROW(flights.run(5, [&]{
+            started = true;
+            while (!release)
+                std::this_thread::yield();
+            throw std::runtime_error("no response");
+        }), std::runtime_error);
+    });
+    while (!started)
+        std::this_thread::yield();
+    std::thread follower([&]{
+        EXPECT_THROW(flights.run(5, []{}), std::runtime_error);
+    });
+    while (flights.shared() < 1)
+        std::this_thread::yield();
+    release = true;
+    leader.join();
+    follower.join();
+    int runs{0};
+    flights.run(5, [&]{ ++runs; });     // a failure is not remembered
+    EXPECT_EQ(runs, 1);
+}
@@ -0,0 +1,80 @@
+#include <sstream>
+#include <string>
+#include "Soak.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+using namespace std::chrono_literals;
+
+TEST(SoakTest, limits) {
+    SoakLimits none;
+    EXPECT_FALSE(none.active());
+    EXPECT_FALSE(none.done(1000000, 24h));
+
+    SoakLimits count;
+    count.iterations = 3;
+    EXPECT_TRUE(count.active());
+    EXPECT_FALSE(count.done(2, 24h));
+    EXPECT_TRUE(count.done(3, 0s));
+
+    SoakLimits time;
+    time.duration = 60s;
+    EXPECT_FALSE(time.done(1000, 59s));
+    EXPECT_TRUE(time.done(0, 60s));
+
+    SoakLimits both;
+    both.iterations = 10;
+    both.duration = 60s;
+    EXPECT_TRUE(both.done(10, 1s));
+    EXPECT_TRUE(both.done(1, 61s));
+    EXPECT_FALSE(both.done(9, 59s));
+}
+
+TEST(SoakTest, summary) {
+    SessionStats stats;
+    for (unsigned i{0}; i < 4; ++i) {
+        PhaseSample connect;
+        connect.bytesSent = 6;
+        connect.bytesReceived = 10;
+        stats.record(Phase::Connect, "", connect);
+        for (const char* item : {"ST1", "ST3"}) {
+            PhaseSample read;
+            read.elapsed = 10ms;
+            read.bytesSent = 10;
+            read.bytesReceived = 100;
+            read.retries = i == 3 ? 1 : 0;
+            stats.record(Phase::Read, item, read);
+        }
+        PhaseSample session;
+        session.elapsed = std::chrono::milliseconds(100 * (i + 1));
+        stats.record(Phase::Session, "", session);
+        stats.sessionDone(i == 3);
+    }
+    auto summary{summarize(stats, 2s)};
+    EXPECT_EQ(summary.sessions, 4u);
+    EXPECT_EQ(summary.failures, 1u);
+    EXPECT_EQ(summary.reads, 8u);
+    EXPECT_EQ(summary.bytes, 4u * 16 + 8u * 110);
+    EXPECT_EQ(summary.retries, 2u);
+    EXPECT_DOUBLE_EQ(summary.readsPerSecond, 4.0);
+    EXPECT_DOUBLE_EQ(summary.bytesPerSecond, 472.0);
+    EXPECT_DOUBLE_EQ(summary.retriesPerKilobyte, 2 * 1024.0 / 944);
+    EXPECT_DOUBLE_EQ(summary.failureRate, 0.25);
+    EXPECT_EQ(summary.max, 400ms);
+    EXPECT_LE(summary.p50, summary.p95);
+    EXPECT_LE(summary.p95, summary.p99);
+    EXPECT_LE(summary.p99, summary.max);
+
+    std::ostringstream out;
+    writeSoakSummary(out, summary);
+    EXPECT_NE(out.str().find("Soak: 4 sessions in 2.0 s, failures: 1 (25.0%)"), std::string::npos) << out.str();
+    EXPECT_NE(out.str().find("Reads: 8, 4.0 per second"), std::string::npos) << out.str();
+}
+
+TEST(SoakTest, emptyRun) {
+    auto summary{summarize(SessionStats{}, 0s)};
+    EXPECT_EQ(summary.sessions, 0u);
+    EXPECT_DOUBLE_EQ(summary.readsPerSecond, 0.0);
+    EXPECT_DOUBLE_EQ(summary.retriesPerKilobyte, 0.0);
+    EXPECT_DOUBLE_EQ(summary.failureRate, 0.0);
+}
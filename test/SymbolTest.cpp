@@ -0,0 +1,48 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include "Symbol.h"
+#include "C12Tables.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+TEST(SymbolTest, equalNamesShareText) {
+    Symbol a{std::string{"FORMAT_CONTROL_1"}};
+    Symbol b{std::string{"FORMAT_"} + "CONTROL_1"};
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(&a.str(), &b.str());
+    EXPECT_EQ(a.str(), "FORMAT_CONTROL_1");
+    EXPECT_NE(a, Symbol{std::string{"FORMAT_CONTROL_2"}});
+}
+
+TEST(SymbolTest, findDoesNotIntern) {
+    auto before{Symbol::count()};
+    EXPECT_FALSE(Symbol::find("NO_SUCH_FIELD_ANYWHERE"));
+    EXPECT_EQ(Symbol::count(), before);
+    EXPECT_FALSE(Symbol{});
+    EXPECT_EQ(Symbol{}.str(), "");
+}
+
+TEST(SymbolTest, tablesShareNames) {
+    Table one{2048, "MY_TEST_TBL", "MY_TEST_RCD", std::string{"\x01\x02", 2}};
+    one.addField("FIRST", Table::fieldtype::UINT, 1);
+    auto before{Symbol::count()};
+    Table two{2048, "MY_TEST_TBL", "MY_TEST_RCD", std::string{"\x03\x04", 2}};
+    two.addField("FIRST", Table::fieldtype::UINT, 1);
+    EXPECT_EQ(Symbol::count(), before);
+    EXPECT_EQ(one.front()->symbol(), two.front()->symbol());
+    EXPECT_EQ(two.value("FIRST"), 3u);
+    EXPECT_EQ(two.value("SECOND"), 0u);
+}
+
+TEST(SymbolTest, concurrentInterning) {
+    std::vector<std::thread> threads;
+    std::vector<Symbol> got(8);
+    for (std::size_t i{0}; i < got.size(); ++i)
+        threads.emplace_back([&got, i]{ got[i] = Symbol{std::string{"CONCURRENT_NAME"}}; });
+    for (auto& t : threads)
+        t.join();
+    for (const auto& sym : got)
+        EXPECT_EQ(sym, got.front());
+}
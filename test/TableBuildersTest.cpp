@@ -0,0 +1,47 @@
+#include <stdexcept>
+#include <string>
+#include "TableBuilders.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+static TableBuilder named(const std::string& name) {
+    return [name](std::string tbldata, Meter&) { return Table{0, name, name + "_RCD", tbldata}; };
+}
+
+TEST(TableBuildersTest, standardTables) {
+    BuilderRegistry reg;
+    reg.add(7, named("SEVEN_TBL"));
+    EXPECT_TRUE(reg.find(7, nullptr));
+    EXPECT_FALSE(reg.find(8, nullptr));
+    EXPECT_FALSE(reg.find(2048 + 7, nullptr));
+    EXPECT_THROW(reg.add(2048, named("BAD_TBL")), std::out_of_range);
+}
+
+TEST(TableBuildersTest, manufacturerSets) {
+    BuilderRegistry reg;
+    reg.add("EE", "", 2048 + 1, named("EE_ANY_TBL"));
+    reg.add("EE", "KV2", 2048 + 1, named("EE_KV2_TBL"));
+    reg.add("EE", "KV2", 2048 + 2, named("EE_KV2_ONLY_TBL"));
+    reg.add("ITRN", "", 2048 + 1, named("ITRN_TBL"));
+    EXPECT_THROW(reg.add("EE", "", 1, named("BAD_TBL")), std::out_of_range);
+
+    auto kv2{reg.select("EE", "KV2")};
+    auto other{reg.select("EE", "I210")};
+    auto itron{reg.select("ITRN", "SENTINEL")};
+    ASSERT_TRUE(kv2);
+    ASSERT_TRUE(other);
+    ASSERT_TRUE(itron);
+    EXPECT_NE(kv2, other);
+    EXPECT_FALSE(reg.select("ELST", "A3"));
+
+    EXPECT_TRUE(reg.find(2048 + 2, kv2));
+    EXPECT_FALSE(reg.find(2048 + 2, other));
+    EXPECT_TRUE(reg.find(2048 + 1, itron));
+    EXPECT_FALSE(reg.find(2048 + 1, nullptr));
+}
+
+TEST(TableBuildersTest, missingPlugin) {
+    BuilderRegistry reg;
+    EXPECT_THROW(reg.loadPlugin("no/such/plugin.so"), std::runtime_error);
+}
@@ -0,0 +1,129 @@
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "TableDiff.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+static Bytes bytes(const std::basic_string<uint8_t>& data) {
+    return Bytes{data.data(), data.size()};
+}
+
+static std::vector<std::pair<std::size_t, std::size_t>> pairs(const std::vector<ByteRange>& ranges) {
+    std::vector<std::pair<std::size_t, std::size_t>> result;
+    for (const auto& range : ranges)
+        result.emplace_back(range.offset, range.size);
+    return result;
+}
+
+TEST(TableDiffTest, changedBytes) {
+    std::basic_string<uint8_t> before(300, 0);
+    auto after{before};
+    EXPECT_TRUE(changedBytes(bytes(before), bytes(after)).empty());
+    after[0] = 1;
+    after[2] = 1;
+    after[3] = 1;
+    // a run across the end of a block is one range
+    for (std::size_t i{60}; i < 70; ++i)
+        after[i] = 2;
+    after[299] = 3;
+    EXPECT_EQ(pairs(changedBytes(bytes(before), bytes(after))),
+        (std::vector<std::pair<std::size_t, std::size_t>>{{0, 1}, {2, 2}, {60, 10}, {299, 1}}));
+    // what only one of them has is changed, joined to a change just before it
+    auto longer{after + std::basic_string<uint8_t>(5, 0)};
+    EXPECT_EQ(pairs(changedBytes(bytes(before), bytes(longer))).back(), (std::pair<std::size_t, std::size_t>{299, 6}));
+    EXPECT_EQ(pairs(changedBytes(bytes(longer), bytes(before))).back(), (std::pair<std::size_t, std::size_t>{299, 6}));
+    EXPECT_EQ(pairs(changedBytes(Bytes{}, bytes(before))), (std::vector<std::pair<std::size_t, std::size_t>>{{0, 300}}));
+}
+
+// a register table: a count, a bitfield, a total block and two tiers of the same block
+static Table makeTable(const std::string& data, std::size_t summations = 2) {
+    auto block{std::make_shared<Record>("DIFF_BLOCK_RCD")};
+    block->addField("SUMMATIONS", Table::fieldtype::UINT, 2, summations);
+    block->addField("DEMAND", Table::fieldtype::UINT, 1);
+    Table tbl{23, "DIFF_REG_TBL", "DIFF_REG_RCD", data};
+    tbl.addField("NBR_RESETS", Table::fieldtype::UINT, 1);
+    tbl.addField("FLAGS", Table::fieldtype::BITFIELD, 1);
+    tbl.addSubfield("FLAGS", "ON", 0);
+    tbl.addField("TOT_DATA_BLOCK", block);
+    tbl.addField("TIER_DATA_BLOCK", block, 2);
+    return tbl;
+}
+
+static std::vector<std::string> paths(const std::vector<FieldChange>& changes) {
+    std::vector<std::string> result;
+    for (const auto& change : changes)
+        result.push_back(change.path);
+    return result;
+}
+
+TEST(TableDiffTest, changedFields) {
+    std::string data(2 + 3 * 5, '\0');
+    auto before{makeTable(data)};
+    EXPECT_TRUE(changedFields(before, makeTable(data)).empty());
+    data[0] = 1;                    // NBR_RESETS
+    data[2 + 2] = 7;                // TOT_DATA_BLOCK.SUMMATIONS[1]
+    data[2 + 5 + 5 + 4] = 9;        // TIER_DATA_BLOCK[1].DEMAND
+    auto after{makeTable(data)};
+    auto changes{changedFields(before, after)};
+    EXPECT_EQ(paths(changes), (std::vector<std::string>{
+        "NBR_RESETS", "TOT_DATA_BLOCK.SUMMATIONS[1]", "TIER_DATA_BLOCK[1].DEMAND"}));
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_EQ(changes[0].field.value(), 1u);
+    EXPECT_EQ(changes[1].field.value(), 7u);
+    EXPECT_EQ(changes[2].field.value(), 9u);
+}
+
+TEST(TableDiffTest, sameLayout) {
+    std::string data(2 + 3 * 5, '\0');
+    EXPECT_TRUE(sameLayout(makeTable(data), makeTable(data)));
+    // the same size made up differently: one summation more, and no tiers
+    auto other{std::make_shared<Record>("DIFF_BLOCK_RCD")};
+    other->addField("SUMMATIONS", Table::fieldtype::UINT, 2, 3);
+    other->addField("DEMAND", Table::fieldtype::UINT, 1);
+    Table changed{23, "DIFF_REG_TBL", "DIFF_REG_RCD", data};
+    changed.addField("NBR_RESETS", Table::fieldtype::UINT, 1);
+    changed.addField("FLAGS", Table::fieldtype::BITFIELD, 1);
+    changed.addField("TOT_DATA_BLOCK", other);
+    changed.addField("TIER_DATA_BLOCK", Table::fieldtype::BINARY, 1, 8);
+    EXPECT_EQ(changed.recordSize(), makeTable(data).recordSize());
+    EXPECT_FALSE(sameLayout(makeTable(data), changed));
+    EXPECT_FALSE(sameLayout(makeTable(data), makeTable(data, 3)));
+}
+
+TEST(TableDiffTest, printChanges) {
+    std::string data(2 + 3 * 5, '\0');
+    auto before{makeTable(data)};
+    std::ostringstream unchanged;
+    printChanges(before, makeTable(data), unchanged);
+    EXPECT_EQ(unchanged.str(), "TABLE 23 DIFF_REG_TBL unchanged\n");
+
+    data[0] = 4;
+    data[1] = 1;
+    std::ostringstream changed;
+    printChanges(before, makeTable(data), changed);
+    EXPECT_EQ(changed.str(), "TABLE 23 DIFF_REG_TBL changed\n    NBR_RESETS = 4\n    FLAGS = {\n\tON = 1\n    }\n");
+
+    // bytes past the layout have no field to show them
+    std::string tail{data + std::string(4, '\0')};
+    auto padded{makeTable(tail)};
+    tail[0] = 5;
+    tail[tail.size() - 3] = '\x1a';
+    tail[tail.size() - 2] = '\x2b';
+    std::ostringstream past;
+    printChanges(padded, makeTable(tail), past);
+    EXPECT_EQ(past.str(), "TABLE 23 DIFF_REG_TBL changed\n    NBR_RESETS = 5\n    BYTES 18-19 = 1A 2B\n");
+    std::ostringstream shorter;
+    printChanges(makeTable(tail), makeTable(data), shorter);
+    EXPECT_EQ(shorter.str(), "TABLE 23 DIFF_REG_TBL changed\n    NBR_RESETS = 4\n    BYTES 17-20 removed\n");
+
+    // a table laid out differently is printed whole
+    std::string longer(2 + 3 * 7, '\0');
+    auto resized{makeTable(longer, 3)};
+    std::ostringstream whole, expected;
+    printChanges(before, resized, whole);
+    resized.printTo(expected);
+    EXPECT_EQ(whole.str(), expected.str());
+}
@@ -0,0 +1,91 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include "TableRegistry.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+static Table makeTable(unsigned number, const std::string& name, std::size_t size, uint8_t fill = 0) {
+    Table tbl{number, name, name + "_RCD", std::string(size, static_cast<char>(fill))};
+    tbl.addField("FIRST", Table::fieldtype::UINT, 1);
+    return tbl;
+}
+
+TEST(TableRegistryTest, findByNumberAndName) {
+    TableRegistry reg;
+    reg.store(makeTable(0, "REG_ZERO_TBL", 4, 7));
+    reg.store(makeTable(2048 + 5, "REG_MFG_TBL", 4, 9));
+    EXPECT_EQ(reg.size(), 2u);
+    ASSERT_TRUE(reg.find(0));
+    EXPECT_EQ(reg.find(0)->value("FIRST"), 7u);
+    ASSERT_TRUE(reg.find(Symbol{"REG_MFG_TBL"}));
+    EXPECT_EQ(reg.find(Symbol{"REG_MFG_TBL"})->Number(), 2053u);
+    EXPECT_FALSE(reg.find(1));
+    EXPECT_FALSE(reg.find(4095));
+    EXPECT_FALSE(reg.find(TableRegistry::slots));
+    EXPECT_FALSE(reg.find(Symbol{"REG_NOT_STORED_TBL"}));
+    EXPECT_EQ(reg.numbers(), (std::vector<unsigned>{0, 2053}));
+    EXPECT_THROW(reg.store(makeTable(TableRegistry::slots, "REG_BAD_TBL", 1)), std::out_of_range);
+}
+
+TEST(TableRegistryTest, rereadReplaces) {
+    TableRegistry reg;
+    reg.store(makeTable(3, "REG_THREE_TBL", 4, 1));
+    auto first{reg.find(3)};
+    reg.store(makeTable(3, "REG_THREE_TBL", 8, 2));
+    EXPECT_EQ(reg.size(), 1u);
+    EXPECT_EQ(reg.bytes(), 8u);
+    EXPECT_EQ(reg.find(Symbol{"REG_THREE_TBL"})->value("FIRST"), 2u);
+    // whoever still holds the old table can keep using it
+    EXPECT_EQ(first->value("FIRST"), 1u);
+}
+
+TEST(TableRegistryTest, erase) {
+    TableRegistry reg;
+    reg.store(makeTable(7, "REG_SEVEN_TBL", 4));
+    reg.erase(7);
+    reg.erase(8);
+    EXPECT_EQ(reg.size(), 0u);
+    EXPECT_EQ(reg.bytes(), 0u);
+    EXPECT_FALSE(reg.find(Symbol{"REG_SEVEN_TBL"}));
+}
+
+TEST(TableRegistryTest, evictsLeastRecentlyUsed) {
+    TableRegistry reg{30};
+    reg.store(makeTable(1, "REG_A_TBL", 10));
+    reg.store(makeTable(2, "REG_B_TBL", 10));
+    reg.store(makeTable(3, "REG_C_TBL", 10));
+    reg.find(1);
+    reg.store(makeTable(4, "REG_D_TBL", 10));
+    EXPECT_EQ(reg.numbers(), (std::vector<unsigned>{1, 3, 4}));
+    EXPECT_EQ(reg.bytes(), 30u);
+    // a table bigger than the limit is still kept, alone
+    reg.store(makeTable(5, "REG_E_TBL", 40));
+    EXPECT_EQ(reg.numbers(), (std::vector<unsigned>{5}));
+    reg.setLimit(0);
+    reg.store(makeTable(6, "REG_F_TBL", 40));
+    EXPECT_EQ(reg.size(), 2u);
+}
+
+TEST(TableRegistryTest, readersDuringReplacement) {
+    TableRegistry reg;
+    reg.store(makeTable(9, "REG_NINE_TBL", 1, 0));
+    std::thread writer{[&reg]{
+        for (int i{1}; i <= 1000; ++i)
+            reg.store(makeTable(9, "REG_NINE_TBL", 1, static_cast<uint8_t>(i)));
+    }};
+    unsigned last{0};
+    bool ordered{true};
+    for (int i{0}; i < 1000; ++i) {
+        auto tbl{reg.find(9)};
+        ASSERT_TRUE(tbl);
+        auto value{tbl->value("FIRST")};
+        // values only move forward, modulo the byte wrapping
+        ordered = ordered && (value >= last || last - value > 128);
+        last = value;
+    }
+    writer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(reg.find(9)->value("FIRST"), 1000u % 256);
+}
@@ -0,0 +1,141 @@
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TableSnapshot.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+static Table makeTable(unsigned number, const std::string& name, uint8_t fill) {
+    Table tbl{number, name, name + "_RCD", std::string(2, static_cast<char>(fill))};
+    tbl.addField("FIRST", Table::fieldtype::UINT, 1);
+    tbl.addField("SECOND", Table::fieldtype::UINT, 1);
+    return tbl;
+}
+
+TEST(TableSnapshotTest, keepsItsTables) {
+    TableSnapshot empty;
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT_EQ(empty.generation(), 0u);
+    EXPECT_FALSE(empty.find(3));
+
+    TableRegistry reg;
+    reg.store(makeTable(3, "SNAP_A_TBL", 1));
+    reg.store(makeTable(2050, "SNAP_B_TBL", 5));
+    TableSnapshot first{reg, 1};
+    reg.store(makeTable(3, "SNAP_A_TBL", 2));
+    reg.erase(2050);
+    TableSnapshot second{reg, 2};
+
+    EXPECT_EQ(first.numbers(), (std::vector<unsigned>{3, 2050}));
+    EXPECT_EQ(first.find(3)->value("FIRST"), 1u);
+    EXPECT_EQ(first.find(Symbol{"SNAP_B_TBL"})->Number(), 2050u);
+    EXPECT_EQ(first.generation(), 1u);
+    EXPECT_EQ(second.numbers(), (std::vector<unsigned>{3}));
+    EXPECT_EQ(second.find(Symbol{"SNAP_A_TBL"})->value("FIRST"), 2u);
+    EXPECT_FALSE(second.find(Symbol{"SNAP_B_TBL"}));
+    EXPECT_FALSE(second.find(Symbol::find("SNAP_NEVER_TBL")));
+}
+
+TEST(TableSnapshotTest, evaluate) {
+    TableRegistry reg;
+    reg.store(makeTable(3, "SNAP_A_TBL", 4));
+    reg.store(makeTable(4, "SNAP_C_TBL", 6));
+    TableSnapshot snapshot{reg, 1};
+    EXPECT_EQ(snapshot.evaluate(Expression{"SNAP_A_TBL.FIRST * SNAP_C_TBL.SECOND"}), 24);
+    EXPECT_EQ(snapshot.evaluate(Expression{"SNAP_A_TBL.MISSING + 1"}), 1);
+    EXPECT_FALSE(snapshot.evaluate(Expression{"SNAP_UNREAD_TBL.FIRST"}));
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_C_TBL.FIRST"), "6");
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_UNREAD_TBL.FIRST"), "");
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_C_TBL"), "");
+}
+
+TEST(TableSnapshotTest, paths) {
+    auto entry{std::make_shared<Record>("SNAP_ENTRY_RCD")};
+    entry->addField("ID", Table::fieldtype::UINT, 1);
+    entry->addField("READINGS", Table::fieldtype::UINT, 2, 2);
+    Table tbl{6, "SNAP_PATH_TBL", "SNAP_PATH_RCD", std::string{"\x21\x09\x01\x00\x02\x00\x0a\x10\x00\x11\x00", 11}};
+    tbl.addField("FLAGS", Table::fieldtype::BITFIELD, 1);
+    tbl.addSubfield("FLAGS", "LOW", 0, 3);
+    tbl.addSubfield("FLAGS", "HIGH", 4, 7);
+    tbl.addField("ENTRIES", entry, 2);
+    TableRegistry reg;
+    reg.store(std::move(tbl));
+    TableSnapshot snapshot{reg, 1};
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_PATH_TBL.FLAGS.HIGH"), "2");
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_PATH_TBL.ENTRIES[1].ID"), "10");
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_PATH_TBL.ENTRIES[0].READINGS[1]"), "2");
+    EXPECT_NE(snapshot.evaluateAsString("SNAP_PATH_TBL.ENTRIES[1]").find('\n'), std::string::npos);
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_PATH_TBL.ENTRIES[2].ID"), "");
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_PATH_TBL.ENTRIES[0].NONE"), "");
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_PATH_TBL.FLAGS.NONE"), "");
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_PATH_TBL.FLAGS.HIGH.MORE"), "");
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_PATH_TBL.ENTRIES[x].ID"), "");
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_PATH_TBL.ENTRIES[0"), "");
+    EXPECT_EQ(snapshot.evaluateAsString("SNAP_PATH_TBL.ENTRIES[0]ID"), "");
+}
+
+// the byte order goes with the tables, so any thread decodes them alike
+TEST(TableSnapshotTest, byteOrder) {
+    TableRegistry reg;
+    Table tbl{5, "SNAP_ORDER_TBL", "SNAP_ORDER_RCD", std::string{"\x12\x34"}};
+    tbl.addField("WIDE", Table::fieldtype::UINT, 2);
+    tbl.setDataOrder(true);
+    reg.store(std::move(tbl));
+    TableSnapshot snapshot{reg, 1};
+    std::optional<long> value;
+    std::string text;
+    std::thread reader{[&]{
+        value = snapshot.evaluate(Expression{"SNAP_ORDER_TBL.WIDE"});
+        text = snapshot.evaluateAsString("SNAP_ORDER_TBL.WIDE");
+    }};
+    reader.join();
+    EXPECT_EQ(value, 0x1234);
+    EXPECT_EQ(text, "4660");
+}
+
+// each session stores both tables with the same value, so a reader seeing them differ saw half a session
+TEST(TableSnapshotTest, readersSeeWholeSessions) {
+    TableRegistry reg;
+    SnapshotCell cell;
+    std::atomic<bool> done{false};
+    std::atomic<unsigned> torn{0};
+    std::atomic<unsigned> seen{0};
+    std::vector<std::thread> readers;
+    for (int i{0}; i < 3; ++i) {
+        readers.emplace_back([&]{
+            std::uint64_t last{0};
+            while (!done) {
+                auto snapshot{cell.load()};
+                if (snapshot->generation() < last)
+                    ++torn;
+                last = snapshot->generation();
+                auto a{snapshot->find(3)};
+                auto b{snapshot->find(4)};
+                if (a && b) {
+                    if (a->value("FIRST") != b->value("FIRST"))
+                        ++torn;
+                    ++seen;
+                }
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (unsigned session{1}; session <= 2000; ++session) {
+        reg.store(makeTable(3, "SNAP_A_TBL", static_cast<uint8_t>(session)));
+        reg.store(makeTable(4, "SNAP_C_TBL", static_cast<uint8_t>(session)));
+        cell.store(std::make_shared<const TableSnapshot>(reg, session));
+        if (session % 100 == 0)
+            std::this_thread::yield();
+    }
+    while (seen == 0)
+        std::this_thread::yield();
+    done = true;
+    for (auto& t : readers)
+        t.join();
+    EXPECT_EQ(torn, 0u);
+    EXPECT_EQ(cell.load()->generation(), 2000u);
+}
@@ -0,0 +1,132 @@
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "Tdl.h"
+#include <gtest/gtest.h>
+
+using namespace C12;
+
+static const char* definitions{R"(
+// a cut down ST0, with the table referring to itself
+TYPE FORMAT_CONTROL_1_BFLD = BIT FIELD OF UINT8
+    DATA_ORDER : UINT(0..0);
+    CHAR_FORMAT : UINT(1..3);
+    FILL(4..7);
+END;
+
+TYPE GEN_CONFIG_RCD = PACKED RECORD
+    FORMAT_CONTROL_1 : FORMAT_CONTROL_1_BFLD;
+    DEVICE_CLASS : BINARY(4);
+    DIM_STD_TBLS_USED : UINT8;
+    STD_TBLS_USED : SET(GEN_CONFIG_TBL.DIM_STD_TBLS_USED);
+END;
+
+TABLE 0 GEN_CONFIG_TBL = GEN_CONFIG_RCD;
+
+MANUFACTURER "EPRI" MODEL "TEST";
+
+TYPE PAIR_RCD = PACKED RECORD
+    FIRST : UINT8;
+    SECOND : UINT16;
+END;
+
+TYPE MY_RCD = PACKED RECORD
+    COUNT : UINT8;
+    { the size of this array is only known from the data }
+    PAIRS : ARRAY[MY_TBL.COUNT] OF PAIR_RCD;
+    IF OTHER_TBL.FLAG && (OTHER_TBL.LIST[2] == 7) THEN
+        EXTRA : STRING(3);
+    ELSE
+        SHORT : UINT8;
+    END;
+END;
+
+MFG TABLE 5 MY_TBL = MY_RCD;
+)"};
+
+static std::vector<TdlTable> read(const std::string& text) {
+    std::istringstream in{text};
+    return readTdl(in);
+}
+
+static Expression::Resolver none{[](const Reference&) -> std::optional<long> { return std::nullopt; }};
+
+TEST(TdlTest, readsTables) {
+    auto tables{read(definitions)};
+    ASSERT_EQ(tables.size(), 2u);
+    EXPECT_EQ(tables[0].number(), 0u);
+    EXPECT_EQ(tables[0].Name(), "GEN_CONFIG_TBL");
+    EXPECT_EQ(tables[0].manufacturer(), "");
+    EXPECT_EQ(tables[1].number(), 2048u + 5);
+    EXPECT_EQ(tables[1].manufacturer(), "EPRI");
+    EXPECT_EQ(tables[1].model(), "TEST");
+}
+
+TEST(TdlTest, buildsOverData) {
+    auto tables{read(definitions)};
+    auto st0{tables[0].build(std::string{"\x0b" "EPRI" "\x02" "\x03\x01", 8}, none)};
+    EXPECT_EQ(st0.Name(), "GEN_CONFIG_TBL");
+    EXPECT_EQ(st0.value("FORMAT_CONTROL_1", "CHAR_FORMAT"), 5u);
+    EXPECT_EQ(st0["STD_TBLS_USED"].value()->size(), 2u);
+    EXPECT_EQ(st0.value("STD_TBLS_USED", 8), 1u);
+    EXPECT_EQ(st0.totalSize(), 8u);
+}
+
+TEST(TdlTest, conditionsAndArrays) {
+    auto tables{read(definitions)};
+    std::string data{"\x02" "\x01\x34\x12" "\x02\x78\x56" "abc", 10};
+    std::map<std::string, long> other{{"FLAG", 1}, {"LIST", 7}};
+    Expression::Resolver resolve{[&other](const Reference& ref) -> std::optional<long> {
+        if (ref.table.str() != "OTHER_TBL")
+            return std::nullopt;
+        return other[ref.field.str()];
+    }};
+    auto tbl{tables[1].build(data, resolve)};
+    EXPECT_EQ(tbl.value("PAIRS", 1, "SECOND"), 0x5678u);
+    ASSERT_TRUE(tbl.field("EXTRA"));
+    EXPECT_EQ(tbl.valueAsString("EXTRA"), "\"abc\"");
+    EXPECT_FALSE(tbl.field("SHORT"));
+    // without the other table the condition is false
+    auto without{tables[1].build(data, none)};
+    EXPECT_FALSE(without.field("EXTRA"));
+    EXPECT_TRUE(without.field("SHORT"));
+}
+
+// a dimension from the table itself is read in the meter's byte order
+TEST(TdlTest, selfReferenceBigEndian) {
+    auto tables{read(R"(
+TYPE WIDE_RCD = PACKED RECORD
+    NBR : UINT16;
+    ITEMS : ARRAY[WIDE_TBL.NBR] OF UINT8;
+END;
+TABLE 7 WIDE_TBL = WIDE_RCD;
+)")};
+    ASSERT_EQ(tables.size(), 1u);
+    std::string data{"\x00\x02" "\x0a\x0b", 4};
+    auto tbl{tables[0].build(data, none, true)};
+    EXPECT_TRUE(tbl.bigEndian());
+    EXPECT_EQ(tbl.value("NBR"), 2u);
+    EXPECT_EQ(tbl["ITEMS"].value()->size(), 2u);
+    EXPECT_EQ(tbl.value("ITEMS", 1), 0x0bu);
+    EXPECT_EQ(tables[0].build(data, none)["ITEMS"].value()->size(), 512u);
+}
+
+TEST(TdlTest, errorsNameTheLine) {
+    const auto message = [](const std::string& text) {
+        try {
+            read(text);
+        }
+        catch (std::runtime_error& ex) {
+            return std::string{ex.what()};
+        }
+        return std::string{};
+    };
+    EXPECT_EQ(message("TABLE 1 X_TBL = NO_RCD;"), "line 1: unknown type NO_RCD");
+    EXPECT_EQ(message("TYPE A = PACKED RECORD\n  B : UINT8\nEND;"), "line 3: ';' expected");
+    EXPECT_EQ(message("\n\nTYPE A = BIT FIELD OF UINT8\n  B : UINT(4..9);\nEND;"), "line 4: bits 4..9 do not fit");
+    EXPECT_EQ(message("TYPE A = PACKED RECORD B : ARRAY[1 +] OF UINT8; END;").substr(0, 8), "line 1: ");
+    EXPECT_EQ(message("WHAT"), "line 1: MANUFACTURER, TYPE or TABLE expected");
+    EXPECT_EQ(message("MFG TABLE 2048 X = Y;"), "line 1: table number 2048 is too large");
+    EXPECT_THROW(readTdl(std::string{"no/such/file.tdl"}), std::runtime_error);
+}